@@ -0,0 +1,53 @@
+#include "adaptive_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vrstorm {
+
+adaptive_resolution::adaptive_resolution(logger &this_log)
+  : log(this_log) {
+  /// Default constructor
+}
+
+void adaptive_resolution::update(float gpu_ms, float budget_ms) {
+  /// Feed in one frame's GPU time, adjusting the scale if it has stayed outside the target band
+  if(!enabled || gpu_ms <= 0.0f || budget_ms <= 0.0f) {
+    return;
+  }
+  smoothed_gpu_ms = smoothed_gpu_ms == 0.0f ? gpu_ms : smoothed_gpu_ms + (gpu_ms - smoothed_gpu_ms) * smoothing;
+  if(++frames_since_change < settle_frames) {
+    return;                                                                     // let the last change show up in the timings first
+  }
+  float const load = smoothed_gpu_ms / budget_ms;
+  if(load <= upper_threshold && load >= lower_threshold) {
+    return;                                                                     // within the band, leave it alone
+  }
+  // GPU time goes roughly with pixel count, the square of the scale, so aim for the middle of the band
+  float const target_load = (upper_threshold + lower_threshold) * 0.5f;
+  float const old_scale = scale.load(std::memory_order_relaxed);
+  float const ideal_scale = old_scale * std::sqrt(target_load / load);
+  float const new_scale = std::clamp(std::clamp(ideal_scale, old_scale - max_decrease, old_scale + max_increase), min_scale, max_scale);
+  if(new_scale == old_scale) {
+    return;
+  }
+  log(logger::level::debug) << "VRStorm: DEBUG: GPU load " << load * 100.0f << "%, render scale changed from " << old_scale << " to " << new_scale;
+  scale.store(new_scale, std::memory_order_relaxed);
+  frames_since_change = 0;
+}
+
+void adaptive_resolution::reset() {
+  /// Return to full resolution and forget timing history
+  smoothed_gpu_ms = 0.0f;
+  frames_since_change = 0;
+  scale.store(max_scale, std::memory_order_relaxed);
+}
+
+float adaptive_resolution::get_scale() const {
+  /// Return the current per-axis render target scale, 1 if disabled
+  if(!enabled) {
+    return 1.0f;
+  }
+  return scale.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include "logger.h"
+
+namespace vrstorm {
+
+class adaptive_resolution {
+  /// Scales the render target to keep GPU frame time within the frame budget, with hysteresis so it doesn't oscillate
+public:
+  bool enabled = false;
+  float min_scale = 0.6f;                                                       // limits of the per-axis render target scale
+  float max_scale = 1.0f;
+  float upper_threshold = 0.9f;                                                 // fraction of the frame budget above which resolution drops
+  float lower_threshold = 0.7f;                                                 // fraction of the frame budget below which resolution may rise
+  float max_decrease = 0.1f;                                                    // largest change in scale per adjustment
+  float max_increase = 0.05f;                                                   // rising is slower than falling, to avoid oscillating
+  unsigned int settle_frames = 15;                                              // frames to wait after a change before changing again
+  float smoothing = 0.1f;                                                       // weight of each new sample in the smoothed GPU time
+
+private:
+  logger &log;
+  float smoothed_gpu_ms = 0.0f;
+  unsigned int frames_since_change = 0;
+  std::atomic<float> scale{1.0f};                                               // written by the thread recording timings, read by the render thread
+
+public:
+  explicit adaptive_resolution(logger &this_log);
+
+  void update(float gpu_ms, float budget_ms);
+  void reset();
+
+  float get_scale() const __attribute__((__pure__));
+};
+
+}
@@ -2,6 +2,7 @@
 
 #include <boost/bimap.hpp>
 #include <boost/bimap/unordered_multiset_of.hpp>
+#include <boost/range/iterator_range.hpp>
 #include "inputstorm/binding_sets/base.h"
 #include "vrstorm/input/controller.h"
 
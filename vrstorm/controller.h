@@ -7,6 +7,8 @@
 #endif // __MINGW32__
 #include "vectorstorm/matrix/matrix4.h"
 #include "input/controller.h"
+#include "render_model_cache.h"
+#include "rigid_pose.h"
 
 namespace vrstorm {
 
@@ -14,10 +16,13 @@ struct controller {
   unsigned int id = 0;
   input::controller::hand_type hand = input::controller::hand_type::UNKNOWN;
 
-  mat4f position;
+  rigid_pose pose;                                                              // controller to absolute tracking space
+  mat4f position;                                                               // the same pose as a full matrix
 
   #ifndef VRSTORM_DISABLED
-    vr::RenderModel_t* model = nullptr;
+    vr::RenderModel_t* model = nullptr;                                         // null until loaded in the background
+    vr::RenderModel_TextureMap_t* texture = nullptr;                            // null until loaded, or if the model has none
+    render_model_cache::draw_range const *mesh = nullptr;                       // null until cached, draw with manager::get_render_models()
   #endif // VRSTORM_DISABLED
 };
 
@@ -0,0 +1,137 @@
+#include "device_registry.h"
+#include <bitset>
+
+namespace vrstorm {
+
+namespace {
+
+device_registry::entry const unregistered;                                      // returned for out of range device indices
+
+}
+
+unsigned int device_registry::get_class_index(vr::ETrackedDeviceClass device_class) {
+  /// Return the class mask a device class is kept in, past the end for invalid or unknown classes
+  switch(device_class) {
+  case vr::TrackedDeviceClass_HMD:
+    return 0;
+  case vr::TrackedDeviceClass_Controller:
+    return 1;
+  case vr::TrackedDeviceClass_TrackingReference:
+    return 2;
+  case vr::TrackedDeviceClass_Other:
+    return 3;
+  default:
+    return std::numeric_limits<unsigned int>::max();
+  }
+}
+
+void device_registry::add(vr::TrackedDeviceIndex_t device_index,
+                          vr::ETrackedDeviceClass device_class,
+                          vr::ETrackedControllerRole role,
+                          unsigned int slot) {
+  /// Register a connected device, replacing whatever was registered at that index
+  if(device_index >= size) {
+    return;
+  }
+  remove(device_index);                                                         // in case it's re-registered as another class
+  entry &this_entry = entries[device_index];
+  this_entry.device_class = device_class;
+  this_entry.role = role;
+  this_entry.hand = input::controller::get_hand_from_role(role);
+  this_entry.slot = slot;
+  ++generations[device_index];
+  connected_mask |= uint64_t{1} << device_index;
+  unsigned int const class_index = get_class_index(device_class);
+  if(class_index < class_masks.size()) {
+    class_masks[class_index] |= uint64_t{1} << device_index;
+  }
+}
+
+void device_registry::remove(vr::TrackedDeviceIndex_t device_index) {
+  /// Forget a device that has disconnected
+  if(device_index >= size) {
+    return;
+  }
+  unsigned int const class_index = get_class_index(entries[device_index].device_class);
+  if(class_index < class_masks.size()) {
+    class_masks[class_index] &= ~(uint64_t{1} << device_index);
+  }
+  entries[device_index] = entry();
+  connected_mask &= ~(uint64_t{1} << device_index);
+}
+
+void device_registry::clear() {
+  /// Forget every device
+  entries.fill(entry());
+  connected_mask = 0;
+  class_masks.fill(0);
+}
+
+void device_registry::set_role(vr::TrackedDeviceIndex_t device_index, vr::ETrackedControllerRole role) {
+  /// Update a registered device's role, and the hand that follows from it
+  if(!get_connected(device_index)) {
+    return;
+  }
+  entries[device_index].role = role;
+  entries[device_index].hand = input::controller::get_hand_from_role(role);
+}
+void device_registry::set_slot(vr::TrackedDeviceIndex_t device_index, unsigned int slot) {
+  /// Update a registered device's position in its list, when another device's removal moves it
+  if(!get_connected(device_index)) {
+    return;
+  }
+  entries[device_index].slot = slot;
+}
+
+bool device_registry::get_connected(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return whether a device is registered
+  return device_index < size && ((connected_mask >> device_index) & 1);
+}
+device_registry::entry const &device_registry::get(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return everything registered about a device, or an empty entry if it isn't connected
+  if(device_index >= size) {
+    return unregistered;
+  }
+  return entries[device_index];
+}
+vr::ETrackedDeviceClass device_registry::get_class(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return the class of a device, invalid if it isn't connected
+  return get(device_index).device_class;
+}
+vr::ETrackedControllerRole device_registry::get_role(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return the controller role of a device
+  return get(device_index).role;
+}
+input::controller::hand_type device_registry::get_hand(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return the hand a device is held in, unknown if it isn't a hand controller
+  return get(device_index).hand;
+}
+unsigned int device_registry::get_slot(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return a device's position in the manager's list for its class, or no_slot
+  return get(device_index).slot;
+}
+uint32_t device_registry::get_generation(vr::TrackedDeviceIndex_t device_index) const {
+  /// Return how many times a device index has been registered, to check a device is still the one an earlier request was made for
+  if(device_index >= size) {
+    return 0;
+  }
+  return generations[device_index];
+}
+uint64_t device_registry::get_connected_mask() const {
+  /// Return a bit per device index, set for each registered device
+  return connected_mask;
+}
+uint64_t device_registry::get_class_mask(vr::ETrackedDeviceClass device_class) const {
+  /// Return a bit per device index, set for each registered device of a class
+  unsigned int const class_index = get_class_index(device_class);
+  if(class_index >= class_masks.size()) {
+    return 0;
+  }
+  return class_masks[class_index];
+}
+unsigned int device_registry::get_count(vr::ETrackedDeviceClass device_class) const {
+  /// Return the number of registered devices of a class
+  return static_cast<unsigned int>(std::bitset<size>(get_class_mask(device_class)).count());
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "input/controller.h"
+
+namespace vrstorm {
+
+class device_registry {
+  /// Connected tracked devices of every class by device index, kept current from activation events so nothing has to scan for them
+public:
+  static unsigned int constexpr size = vr::k_unMaxTrackedDeviceCount;
+  static unsigned int constexpr no_slot = std::numeric_limits<unsigned int>::max();
+  static_assert(size <= 64, "device_registry masks are 64 bits wide");
+
+  struct entry {
+    vr::ETrackedDeviceClass device_class = vr::TrackedDeviceClass_Invalid;     // invalid while not connected
+    vr::ETrackedControllerRole role = vr::TrackedControllerRole_Invalid;
+    input::controller::hand_type hand = input::controller::hand_type::UNKNOWN;
+    unsigned int slot = no_slot;                                                // position in the manager's list for this class, if it has one
+  };
+
+private:
+  std::array<entry, size> entries;
+  std::array<uint32_t, size> generations{};                                     // incremented each time a device index is registered, so a reused index can be told apart
+  uint64_t connected_mask = 0;                                                  // bit per device, set while registered
+  std::array<uint64_t, 4> class_masks{};                                        // bit per device of each valid class, set while registered, by get_class_index()
+
+  static unsigned int get_class_index(vr::ETrackedDeviceClass device_class) __attribute__((__const__));
+
+public:
+  void add(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceClass device_class, vr::ETrackedControllerRole role, unsigned int slot);
+  void remove(vr::TrackedDeviceIndex_t device_index);
+  void clear();
+
+  void set_role(vr::TrackedDeviceIndex_t device_index, vr::ETrackedControllerRole role);
+  void set_slot(vr::TrackedDeviceIndex_t device_index, unsigned int slot);
+
+  bool get_connected(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  entry const &get(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  vr::ETrackedDeviceClass get_class(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  vr::ETrackedControllerRole get_role(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  input::controller::hand_type get_hand(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  unsigned int get_slot(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  uint32_t get_generation(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  uint64_t get_connected_mask() const __attribute__((__pure__));
+  uint64_t get_class_mask(vr::ETrackedDeviceClass device_class) const __attribute__((__pure__));
+  unsigned int get_count(vr::ETrackedDeviceClass device_class) const __attribute__((__pure__));
+};
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "vectorstorm/matrix/matrix4.h"
+
+namespace vrstorm {
+
+struct eye_matrices {
+  /// Precomputed camera matrices for one eye, laid out to match a std140 uniform block of three mat4s
+  mat4f view;                                                                   // eye from absolute tracking space
+  mat4f projection;
+  mat4f view_projection;                                                        // projection * view
+};
+
+static_assert(sizeof(mat4f) == sizeof(float) * 16, "eye_matrices must be tightly packed to be copied to a uniform buffer");
+
+}
@@ -0,0 +1,125 @@
+#include "frame_timing.h"
+#include <algorithm>
+#include <vector>
+
+namespace vrstorm {
+
+namespace {
+
+frame_timing_percentiles get_percentiles(std::vector<float> &values) {
+  /// Find the percentiles of a set of values, reordering them in the process
+  frame_timing_percentiles result;
+  if(values.empty()) {
+    return result;
+  }
+  auto const percentile = [&](float fraction){
+    auto const nth(values.begin() + static_cast<std::ptrdiff_t>(fraction * static_cast<float>(values.size() - 1)));
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+  };
+  result.p50 = percentile(0.50f);
+  result.p95 = percentile(0.95f);
+  result.p99 = percentile(0.99f);
+  return result;
+}
+
+}
+
+void frame_timing_ring::push(frame_timing_sample const &sample) {
+  /// Add a new sample, overwriting the oldest - only one thread may push
+  uint64_t const count = write_count.load(std::memory_order_relaxed);
+  slot &this_slot = slots[count % size];
+  uint32_t const sequence = this_slot.sequence.load(std::memory_order_relaxed);
+  this_slot.sequence.store(sequence + 1, std::memory_order_relaxed);           // mark as being written
+  std::atomic_thread_fence(std::memory_order_release);
+  this_slot.sample = sample;
+  this_slot.sequence.store(sequence + 2, std::memory_order_release);
+  write_count.store(count + 1, std::memory_order_release);
+}
+
+unsigned int frame_timing_ring::copy(std::array<frame_timing_sample, size> &out) const {
+  /// Copy out the held samples, oldest first, skipping any overwritten while copying; returns the number copied
+  uint64_t const count = write_count.load(std::memory_order_acquire);
+  uint64_t const available = std::min<uint64_t>(count, size);
+  unsigned int copied = 0;
+  for(uint64_t i = count - available; i != count; ++i) {
+    slot const &this_slot = slots[i % size];
+    uint32_t const sequence_before = this_slot.sequence.load(std::memory_order_acquire);
+    if(sequence_before & 1) {
+      continue;                                                                 // being written right now
+    }
+    out[copied] = this_slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(this_slot.sequence.load(std::memory_order_relaxed) == sequence_before) {
+      ++copied;                                                                 // otherwise it was torn, so drop it
+    }
+  }
+  return copied;
+}
+
+frame_timing_sample frame_timing_ring::get_latest() const {
+  /// Return the most recent sample, or an empty one if there are none
+  frame_timing_sample result;
+  uint64_t const count = write_count.load(std::memory_order_acquire);
+  if(count == 0) {
+    return result;
+  }
+  slot const &this_slot = slots[(count - 1) % size];
+  uint32_t sequence_before;
+  do {
+    sequence_before = this_slot.sequence.load(std::memory_order_acquire);
+    result = this_slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while((sequence_before & 1) || this_slot.sequence.load(std::memory_order_relaxed) != sequence_before);
+  return result;
+}
+
+frame_timing_stats frame_timing_ring::get_stats() const {
+  /// Summarise the held samples as percentiles and totals
+  std::array<frame_timing_sample, size> samples;
+  frame_timing_stats result;
+  result.samples = copy(samples);
+  if(result.samples == 0) {
+    return result;
+  }
+  std::vector<float> cpu_ms;
+  std::vector<float> wait_ms;
+  std::vector<float> gpu_ms;
+  std::vector<float> compositor_cpu_ms;
+  std::vector<float> fence_wait_ms;
+  std::vector<float> dropped_frames;
+  cpu_ms.reserve(result.samples);
+  wait_ms.reserve(result.samples);
+  gpu_ms.reserve(result.samples);
+  compositor_cpu_ms.reserve(result.samples);
+  fence_wait_ms.reserve(result.samples);
+  dropped_frames.reserve(result.samples);
+  for(unsigned int i = 0; i != result.samples; ++i) {
+    frame_timing_sample const &sample = samples[i];
+    cpu_ms.emplace_back(sample.update_ms + sample.events_ms + sample.poll_ms);
+    wait_ms.emplace_back(sample.wait_ms);
+    fence_wait_ms.emplace_back(sample.fence_wait_ms);
+    if(sample.frame_index != 0) {                                               // only include frames the compositor had timing for
+      gpu_ms.emplace_back(sample.gpu_ms);
+      compositor_cpu_ms.emplace_back(sample.compositor_cpu_ms);
+      dropped_frames.emplace_back(static_cast<float>(sample.dropped_frames));
+      result.missed_presents += sample.dropped_frames;
+      if(sample.reprojection_flags != 0) {
+        ++result.reprojected_frames;
+      }
+    }
+  }
+  result.cpu_ms            = get_percentiles(cpu_ms);
+  result.wait_ms           = get_percentiles(wait_ms);
+  result.gpu_ms            = get_percentiles(gpu_ms);
+  result.compositor_cpu_ms = get_percentiles(compositor_cpu_ms);
+  result.fence_wait_ms     = get_percentiles(fence_wait_ms);
+  result.dropped_frames    = get_percentiles(dropped_frames);
+  frame_timing_sample const &latest = samples[result.samples - 1];
+  result.total_frame_presents     = latest.total_frame_presents;
+  result.total_dropped_frames     = latest.total_dropped_frames;
+  result.total_reprojected_frames = latest.total_reprojected_frames;
+  return result;
+}
+
+}
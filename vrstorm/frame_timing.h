@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace vrstorm {
+
+struct frame_timing_sample {
+  /// Timings for one frame, from the compositor and from VRStorm itself
+  uint32_t frame_index = 0;                                                     // compositor frame index, 0 if the compositor had no timing
+  // compositor timing, for the most recently completed frame
+  float gpu_ms = 0.0f;                                                          // total GPU time, application and compositor
+  float compositor_cpu_ms = 0.0f;
+  float client_frame_interval_ms = 0.0f;                                        // time between the application's submits
+  uint32_t frame_presents = 0;                                                  // times this frame was presented, more than one means it was repeated
+  uint32_t dropped_frames = 0;                                                  // presents missed on this frame
+  uint32_t reprojection_flags = 0;                                              // non-zero if the compositor reprojected this frame
+  // VRStorm's own timing for this frame
+  float wait_ms = 0.0f;                                                         // blocked waiting for poses
+  float update_ms = 0.0f;                                                       // converting poses
+  float events_ms = 0.0f;                                                       // dispatching events
+  float poll_ms = 0.0f;                                                         // polling controller axes
+  float fence_wait_ms = 0.0f;                                                   // waiting in end_frame() for the GPU to finish, if fenced
+  // compositor cumulative stats as of this frame
+  uint32_t total_frame_presents = 0;
+  uint32_t total_dropped_frames = 0;
+  uint32_t total_reprojected_frames = 0;
+};
+
+struct frame_timing_percentiles {
+  float p50 = 0.0f;
+  float p95 = 0.0f;
+  float p99 = 0.0f;
+};
+
+struct frame_timing_stats {
+  /// Summary of the frames currently held in a frame_timing_ring
+  unsigned int samples = 0;                                                     // number of frames summarised
+  frame_timing_percentiles cpu_ms;                                              // VRStorm's own time per frame, excluding waits
+  frame_timing_percentiles wait_ms;
+  frame_timing_percentiles gpu_ms;
+  frame_timing_percentiles compositor_cpu_ms;
+  frame_timing_percentiles fence_wait_ms;                                       // last draw to GPU completion, if end_frame() is fenced
+  frame_timing_percentiles dropped_frames;                                      // missed presents per frame
+  unsigned int reprojected_frames = 0;                                          // frames in the window the compositor reprojected
+  unsigned int missed_presents = 0;                                             // presents missed in the window
+  // cumulative since the application started, from the latest frame
+  uint32_t total_frame_presents = 0;
+  uint32_t total_dropped_frames = 0;
+  uint32_t total_reprojected_frames = 0;
+};
+
+class frame_timing_ring {
+  /// Fixed-size lock-free ring of recent frame timings, written by one thread and readable from any other
+public:
+  static unsigned int constexpr size = 256;
+
+private:
+  struct slot {
+    std::atomic<uint32_t> sequence{0};                                          // odd while the sample is being written
+    frame_timing_sample sample;
+  };
+
+  std::array<slot, size> slots;
+  std::atomic<uint64_t> write_count{0};
+
+public:
+  void push(frame_timing_sample const &sample);
+
+  unsigned int copy(std::array<frame_timing_sample, size> &out) const;
+  frame_timing_sample get_latest() const;
+  frame_timing_stats get_stats() const;
+};
+
+}
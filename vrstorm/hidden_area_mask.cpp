@@ -0,0 +1,177 @@
+#include "hidden_area_mask.h"
+#include <algorithm>
+#include <string>
+
+namespace vrstorm {
+
+namespace {
+
+GLuint compile_shader(logger &log, GLenum type, char const *source) {
+  /// Compile a single shader stage, returning zero and logging on failure
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint status = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if(status != GL_TRUE) {
+    GLint log_length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+    std::string info_log(static_cast<size_t>(std::max(log_length, 1)), '\0');
+    glGetShaderInfoLog(shader, log_length, nullptr, &info_log[0]);
+    log(logger::level::error) << "VRStorm: ERROR: failed to compile hidden area mask shader: " << info_log;
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+}
+
+hidden_area_mask::hidden_area_mask(logger &this_log)
+  : log(this_log) {
+  /// Default constructor
+}
+
+void hidden_area_mask::update(vr::IVRSystem *hmd_handle) {
+  /// Fetch both eyes' hidden area meshes from the runtime - they're uploaded on the next draw
+  std::lock_guard<std::mutex> lock(mutex);
+  vertices.clear();
+  for(auto const eye : {vr::Eye_Left, vr::Eye_Right}) {
+    vr::HiddenAreaMesh_t const mesh = hmd_handle->GetHiddenAreaMesh(eye);
+    eye_range &range = ranges[static_cast<unsigned int>(eye)];
+    range.first = static_cast<GLint>(vertices.size());
+    range.count = static_cast<GLsizei>(mesh.unTriangleCount * 3);
+    if(mesh.pVertexData) {
+      vertices.insert(vertices.end(), mesh.pVertexData, mesh.pVertexData + range.count);
+    } else {
+      range.count = 0;                                                          // this headset has no hidden area for this eye
+    }
+  }
+  log(logger::level::info) << "VRStorm: Hidden area mesh: " << ranges[vr::Eye_Left].count / 3 << " left and " << ranges[vr::Eye_Right].count / 3 << " right eye tris";
+  dirty = true;
+}
+
+void hidden_area_mask::shutdown() {
+  /// Delete all GL objects - requires the GL context to be current
+  std::lock_guard<std::mutex> lock(mutex);
+  if(vertex_buffer) {
+    glDeleteBuffers(1, &vertex_buffer);
+  }
+  if(vertex_array) {
+    glDeleteVertexArrays(1, &vertex_array);
+  }
+  if(program) {
+    glDeleteProgram(program);
+  }
+  vertex_buffer = 0;
+  vertex_array  = 0;
+  program       = 0;
+  vertices.clear();
+  ranges = {};
+  dirty = false;
+}
+
+void hidden_area_mask::draw(vr::EVREye eye) {
+  /// Write the nearest depth over this eye's hidden area, leaving colour untouched - call with the eye's viewport set, before the main pass
+  // stencil state is left to the caller, so the mask can also be written to the stencil buffer if set up beforehand
+  std::lock_guard<std::mutex> lock(mutex);
+  if(dirty) {
+    upload();
+  }
+  eye_range const &range = ranges[static_cast<unsigned int>(eye)];
+  if(range.count == 0 || !program) {
+    return;
+  }
+  GLboolean colour_mask[4];
+  GLboolean depth_mask;
+  GLint depth_func;
+  GLint previous_program;
+  GLint previous_vertex_array;
+  glGetBooleanv(GL_COLOR_WRITEMASK, colour_mask);
+  glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+  glGetIntegerv(GL_DEPTH_FUNC, &depth_func);
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vertex_array);
+  bool const depth_test = glIsEnabled(GL_DEPTH_TEST);
+
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glDepthMask(GL_TRUE);
+  glDepthFunc(GL_ALWAYS);
+  glEnable(GL_DEPTH_TEST);                                                      // depth writes require the depth test to be enabled
+  glUseProgram(program);
+  glBindVertexArray(vertex_array);
+  glDrawArrays(GL_TRIANGLES, range.first, range.count);
+
+  glBindVertexArray(static_cast<GLuint>(previous_vertex_array));
+  glUseProgram(static_cast<GLuint>(previous_program));
+  if(!depth_test) {
+    glDisable(GL_DEPTH_TEST);
+  }
+  glDepthFunc(static_cast<GLenum>(depth_func));
+  glDepthMask(depth_mask);
+  glColorMask(colour_mask[0], colour_mask[1], colour_mask[2], colour_mask[3]);
+}
+
+void hidden_area_mask::upload() {
+  /// Copy the meshes to the GPU - the mutex must be held
+  if(!program && !init_program()) {
+    dirty = false;                                                              // don't retry every frame
+    return;
+  }
+  if(!vertex_array) {
+    glGenVertexArrays(1, &vertex_array);
+    glGenBuffers(1, &vertex_buffer);
+    glBindVertexArray(vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glEnableVertexAttribArray(attrib_position);
+    glVertexAttribPointer(attrib_position, 2, GL_FLOAT, GL_FALSE, sizeof(vr::HmdVector2_t), nullptr);
+  } else {
+    glBindVertexArray(vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+  }
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(vr::HmdVector2_t)), vertices.data(), GL_STATIC_DRAW);
+  glBindVertexArray(0);
+  vertices.clear();
+  vertices.shrink_to_fit();                                                     // the GPU copy is all we need now
+  dirty = false;
+}
+
+bool hidden_area_mask::init_program() {
+  /// Build the shader program that draws the mask at the near plane
+  // mesh coordinates are 0 to 1 texture coordinates across the eye's viewport
+  char const *vertex_source =
+    "#version 150\n"
+    "in vec2 position;\n"
+    "void main() {\n"
+    "  gl_Position = vec4(position * 2.0 - 1.0, -1.0, 1.0);\n"
+    "}\n";
+  char const *fragment_source =
+    "#version 150\n"
+    "void main() {\n"
+    "}\n";
+  GLuint const vertex_shader   = compile_shader(log, GL_VERTEX_SHADER,   vertex_source);
+  GLuint const fragment_shader = compile_shader(log, GL_FRAGMENT_SHADER, fragment_source);
+  if(!vertex_shader || !fragment_shader) {
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    return false;
+  }
+  program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glBindAttribLocation(program, attrib_position, "position");
+  glLinkProgram(program);
+  glDeleteShader(vertex_shader);                                                // flagged for deletion, freed along with the program
+  glDeleteShader(fragment_shader);
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if(status != GL_TRUE) {
+    log(logger::level::error) << "VRStorm: ERROR: failed to link hidden area mask shader program";
+    glDeleteProgram(program);
+    program = 0;
+    return false;
+  }
+  return true;
+}
+
+}
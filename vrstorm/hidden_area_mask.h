@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include <GL/glew.h>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "logger.h"
+
+namespace vrstorm {
+
+class hidden_area_mask {
+  /// Draws each eye's hidden area mesh into depth, so pixels the lenses can't show are rejected before shading
+  struct eye_range {
+    GLint first = 0;                                                            // first vertex of this eye in the shared buffer
+    GLsizei count = 0;
+  };
+
+  logger &log;
+  mutable std::mutex mutex;                                                     // meshes may be refreshed from the frame thread, but are drawn on the render thread
+  std::vector<vr::HmdVector2_t> vertices;                                       // both eyes, left then right, released once uploaded
+  std::array<eye_range, 2> ranges;
+  bool dirty = false;
+
+  GLuint program       = 0;
+  GLuint vertex_array  = 0;
+  GLuint vertex_buffer = 0;
+
+public:
+  static GLuint constexpr attrib_position = 0;
+
+  explicit hidden_area_mask(logger &this_log);
+
+  void update(vr::IVRSystem *hmd_handle);
+  void shutdown();
+
+  void draw(vr::EVREye eye);
+
+private:
+  void upload();
+  bool init_program();
+};
+
+}
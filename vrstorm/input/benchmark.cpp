@@ -0,0 +1,375 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include "vrstorm/binding_sets/controller_button.h"
+#include "vrstorm/manager.h"
+#include "vrstorm/rigid_pose.h"
+
+#ifdef VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+  // replacing the global allocator affects the whole program, so this is only built in when asked for
+  namespace {
+
+  std::atomic<uint64_t> allocation_count{0};
+
+  }
+
+  void *operator new(size_t size) {
+    /// Counting replacement for the global allocator
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if(void *pointer = std::malloc(size == 0 ? 1 : size)) {
+      return pointer;
+    }
+    throw std::bad_alloc();
+  }
+  void operator delete(void *pointer) noexcept {
+    /// Release memory from the counting allocator
+    std::free(pointer);
+  }
+  void operator delete(void *pointer, size_t size [[maybe_unused]]) noexcept {
+    /// Release memory from the counting allocator
+    std::free(pointer);
+  }
+#endif // VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+
+namespace vrstorm::input {
+
+namespace {
+
+using bindtype = controller::binding_button::bindtype;
+
+enum class benchmark_control : unsigned int {
+  FIRST,
+  LAST = 256                                                                    // controls are numbered from zero, so this caps the control count measured
+};
+
+struct equal_switch {
+  /// Binding equality predicate using the switch formulation
+  bool operator()(controller::binding_button const &lhs, controller::binding_button const &rhs) const {
+    return lhs.equals_switch(rhs);
+  }
+};
+struct equal_branch {
+  /// Binding equality predicate using the branch formulation
+  bool operator()(controller::binding_button const &lhs, controller::binding_button const &rhs) const {
+    return lhs.equals_branch(rhs);
+  }
+};
+
+std::array<bindtype, 3> constexpr bindtypes{
+  bindtype::SPECIFIC,
+  bindtype::ANY,
+  bindtype::ANY_ALL
+};
+
+std::string get_bindtype_name(bindtype type) {
+  /// Return the name of a button binding type
+  switch(type) {
+  case bindtype::SPECIFIC:
+    return "SPECIFIC";
+  case bindtype::ANY:
+    return "ANY";
+  case bindtype::ANY_ALL:
+    return "ANY_ALL";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+uint64_t get_allocation_count() {
+  /// Return the number of heap allocations made so far by the whole process, or zero if not counting
+  #ifdef VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+    return allocation_count.load(std::memory_order_relaxed);
+  #else
+    return 0;
+  #endif // VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+}
+
+template<typename T>
+benchmark::result measure(std::string const &name, unsigned int iterations, unsigned int warmup, T &&call) {
+  /// Time a number of calls after a warmup, counting the allocations they make
+  for(unsigned int i = 0; i != warmup; ++i) {
+    call(i);
+  }
+  iterations = std::max(iterations, 1u);
+  uint64_t const allocations_before = get_allocation_count();
+  auto const time_start = std::chrono::steady_clock::now();
+  for(unsigned int i = 0; i != iterations; ++i) {
+    call(i);
+  }
+  auto const time_end = std::chrono::steady_clock::now();
+  uint64_t const allocations = get_allocation_count() - allocations_before;
+  benchmark::result result;
+  result.name = name;
+  result.iterations = iterations;
+  double const seconds = std::chrono::duration<double>(time_end - time_start).count();
+  result.nanoseconds_per_call = seconds * 1.0e9 / iterations;
+  result.calls_per_second = seconds > 0.0 ? iterations / seconds : 0.0;
+  if(benchmark::get_counting_allocations()) {
+    result.allocations_per_call = static_cast<double>(allocations) / iterations;
+  }
+  return result;
+}
+
+template<typename... Args>
+std::function<void(Args...)> combine(std::vector<std::function<void(Args...)>> const &funcs) {
+  /// Combine the callbacks of several controls bound to one input, the way the binding sets do
+  if(funcs.size() == 1) {
+    return funcs[0];                                                            // there's only one function, so bind it directly
+  }
+  return [funcs](Args... args){
+    for(auto const &this_func : funcs) {
+      this_func(args...);
+    }
+  };
+}
+
+template<typename T>
+void measure_binding_equality(std::vector<benchmark::result> &results,
+                              std::string const &formulation,
+                              std::vector<controller::binding_button> const &bindings,
+                              unsigned int iterations,
+                              unsigned int warmup,
+                              uint64_t &matches) {
+  /// Measure binding comparisons with one equality formulation, for each type of key
+  T const equal;
+  for(auto const type : bindtypes) {
+    results.emplace_back(measure("binding_equality", iterations, warmup, [&](unsigned int i){
+      controller::binding_button key = bindings[i % bindings.size()];
+      key.type = type;
+      for(auto const &this_binding : bindings) {                                // one call compares the key with every bound control
+        if(equal(key, this_binding)) {
+          ++matches;
+        }
+      }
+    }));
+    results.back().bindtype = get_bindtype_name(type);
+    results.back().formulation = formulation;
+    results.back().controls = static_cast<unsigned int>(bindings.size());
+  }
+}
+
+void measure_binding_set_update(std::vector<benchmark::result> &results,
+                                controller &input_controller,
+                                std::vector<controller::binding_button> const &bindings,
+                                unsigned int iterations,
+                                unsigned int warmup,
+                                uint64_t &calls) {
+  /// Measure the controller button binding set rebinding one button, through its own update(), for each type of key
+  inputstorm::binding_manager<benchmark_control> binding_manager;
+  binding_sets::controller_button<benchmark_control> binding_set(binding_manager, input_controller);
+  for(unsigned int control = 0; control != bindings.size(); ++control) {
+    binding_manager.action_bindings_digital[control].press = [&calls]{++calls;};
+    binding_set.bind(static_cast<benchmark_control>(control), bindings[control].hand, bindings[control].button);
+  }
+  for(auto const type : bindtypes) {
+    results.emplace_back(measure("binding_set_lookup", iterations, warmup, [&](unsigned int i){
+      controller::binding_button key = bindings[i % bindings.size()];
+      key.type = type;
+      binding_set.update(key);                                                  // lookup, collation and rebinding, with the build's binding equality
+    }));
+    results.back().bindtype = get_bindtype_name(type);
+    #ifdef INPUTSTORM_EQUALITY_COMPARISON_SWITCH
+      results.back().formulation = "switch";
+    #else
+      results.back().formulation = "branch";
+    #endif // INPUTSTORM_EQUALITY_COMPARISON_SWITCH
+    results.back().controls = static_cast<unsigned int>(bindings.size());
+  }
+  input_controller.unbind_button_any_all();
+}
+
+void measure_pose_inverse(std::vector<benchmark::result> &results, unsigned int iterations, unsigned int warmup, float &total) {
+  /// Measure turning a tracked device pose into a view matrix, with the rigid inverse and with the general 4x4 inverse it replaced
+  std::vector<std::array<float, 12>> poses;                                     // row-major 3x4, as vr::HmdMatrix34_t
+  for(unsigned int i = 0; i != 64; ++i) {                                       // a spread of orientations and positions, as a moving headset
+    float const yaw   = static_cast<float>(i) * 0.1f;
+    float const pitch = static_cast<float>(i) * 0.037f;
+    float const cy = std::cos(yaw);
+    float const sy = std::sin(yaw);
+    float const cp = std::cos(pitch);
+    float const sp = std::sin(pitch);
+    poses.emplace_back(std::array<float, 12>{ cy, sy * sp, sy * cp, std::sin(yaw * 2.0f) * 0.5f,
+                                             0.0f,      cp,     -sp, 1.5f,
+                                              -sy, cy * sp, cy * cp, std::cos(yaw * 2.0f) * 0.5f});
+  }
+
+  results.emplace_back(measure("pose_inverse", iterations, warmup, [&](unsigned int i){
+    mat4f result;
+    rigid_pose::from_row_major_34_array(poses[i % poses.size()].data()).inverse().to_mat4(result); // as manager::update_poses()
+    total += result.get_translation().x;
+  }));
+  results.back().formulation = "rigid";
+
+  results.emplace_back(measure("pose_inverse", iterations, warmup, [&](unsigned int i){
+    mat4f const result(mat4f::from_row_major_34_array(poses[i % poses.size()].data()).inverse()); // as before rigid_pose
+    total += result.get_translation().x;
+  }));
+  results.back().formulation = "general";
+}
+
+}
+
+std::vector<benchmark::result> benchmark::run() const {
+  /// Run each case with each number of controls against a private manager on the stub runtime - don't run while another manager uses the stub
+  std::vector<result> results;
+  float pose_total = 0.0f;                                                      // sink, so the work can't be optimised away
+  measure_pose_inverse(results, iterations, warmup, pose_total);
+  #ifndef VRSTORM_DISABLED
+    manager vr;
+    vr.log.set_level(logger::level::warning);                                   // measure with the logging a release build would have
+    vr.stub.paced = false;                                                      // never sleep waiting for frames
+    vr.stub.event_rate = 0.0f;
+    vr.init(manager::backend_type::STUB);
+    if(!vr.enabled) {
+      vr.log(logger::level::error) << "VRStorm: ERROR: input benchmark could not start the stub runtime";
+      return results;
+    }
+    controller &input_controller = vr.input_controller;
+    input_controller.skip_unchanged = false;                                    // the stub's packets don't change between polls here, and the dispatch is what's measured
+    uint64_t calls = 0;                                                         // sinks, so the work can't be optimised away
+    float total = 0.0f;
+    uint64_t matches = 0;
+
+    struct axis_slot {
+      controller::hand_type hand;
+      unsigned int axis;
+      controller::axis_direction_type direction;
+    };
+    std::vector<axis_slot> axis_slots;
+    for(auto const hand : {controller::hand_type::LEFT, controller::hand_type::RIGHT}) {
+      for(unsigned int axis = 0; axis != controller::max_axis; ++axis) {
+        axis_slots.emplace_back(axis_slot{hand, axis, controller::axis_direction_type::X});
+        axis_slots.emplace_back(axis_slot{hand, axis, controller::axis_direction_type::Y});
+      }
+    }
+
+    for(unsigned int const controls : control_counts) {
+      if(controls == 0 || controls > static_cast<unsigned int>(benchmark_control::LAST)) {
+        continue;
+      }
+      std::vector<controller::binding_button> bindings;                         // each control on its own button, alternating hands
+      for(unsigned int control = 0; control != controls; ++control) {
+        bindings.emplace_back(controller::binding_button{
+          control % 2 == 0 ? controller::hand_type::LEFT : controller::hand_type::RIGHT,
+          bindtype::SPECIFIC,
+          (control / 2) % controller::max_button
+        });
+      }
+
+      // button dispatch, with each control on its own button, or all sharing one wildcard binding
+      for(auto const type : bindtypes) {
+        input_controller.unbind_button_any_all();
+        std::vector<controller::binding_button> inputs;                         // buttons pressed in turn
+        if(type == bindtype::SPECIFIC) {
+          for(auto const &this_binding : bindings) {
+            input_controller.bind_button(this_binding, [&calls]{++calls;});
+          }
+          inputs = bindings;
+        } else {
+          std::vector<std::function<void()>> funcs(controls, [&calls]{++calls;});
+          input_controller.bind_button(controller::binding_button{controller::hand_type::LEFT, type, 0}, combine(funcs));
+          for(auto const hand : {controller::hand_type::LEFT, controller::hand_type::RIGHT}) {
+            if(hand == controller::hand_type::RIGHT && type == bindtype::ANY) {
+              continue;
+            }
+            for(unsigned int button = 0; button != controller::max_button; ++button) {
+              inputs.emplace_back(controller::binding_button{hand, type, button});
+            }
+          }
+        }
+        results.emplace_back(measure("execute_button", iterations, warmup, [&](unsigned int i){
+          auto const &this_input(inputs[i % inputs.size()]);
+          input_controller.execute_button(this_input.hand, this_input.button, controller::actiontype::PRESS);
+        }));
+        results.back().bindtype = get_bindtype_name(type);
+        results.back().controls = controls;
+      }
+      input_controller.unbind_button_any_all();
+
+      // axis dispatch and polling, with controls spread over the axes and combined where they share one
+      input_controller.unbind_axis_any_all();
+      std::vector<std::vector<std::function<void(float)>>> slot_funcs(axis_slots.size());
+      for(unsigned int control = 0; control != controls; ++control) {
+        slot_funcs[control % axis_slots.size()].emplace_back([&total](float value){total += value;});
+      }
+      std::vector<axis_slot> bound_slots;
+      for(unsigned int slot = 0; slot != axis_slots.size(); ++slot) {
+        if(slot_funcs[slot].empty()) {
+          continue;
+        }
+        auto const &this_slot(axis_slots[slot]);
+        input_controller.bind_axis(this_slot.hand, this_slot.axis, this_slot.direction, combine(slot_funcs[slot]));
+        bound_slots.emplace_back(this_slot);
+      }
+      results.emplace_back(measure("execute_axis", iterations, warmup, [&](unsigned int i){
+        auto const &this_slot(bound_slots[i % bound_slots.size()]);
+        input_controller.execute_axis(this_slot.hand, this_slot.axis, this_slot.direction, 0.5f);
+      }));
+      results.back().controls = controls;
+      results.emplace_back(measure("poll", iterations, warmup, [&](unsigned int i [[maybe_unused]]){
+        input_controller.poll();
+      }));
+      results.back().controls = controls;
+      input_controller.unbind_axis_any_all();
+
+      // binding comparisons with each equality formulation, and binding set updates with the one this build uses
+      measure_binding_equality<equal_switch>(results, "switch", bindings, iterations, warmup, matches);
+      measure_binding_equality<equal_branch>(results, "branch", bindings, iterations, warmup, matches);
+      measure_binding_set_update(results, input_controller, bindings, iterations, warmup, calls);
+    }
+
+    vr.log(logger::level::debug) << "VRStorm: DEBUG: input benchmark sinks " << calls << " " << total << " " << matches << " " << pose_total;
+    vr.shutdown();
+  #endif // VRSTORM_DISABLED
+  return results;
+}
+
+bool benchmark::get_counting_allocations() {
+  /// Return whether this build counts heap allocations, by defining VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+  #ifdef VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+    return true;
+  #else
+    return false;
+  #endif // VRSTORM_BENCHMARK_COUNT_ALLOCATIONS
+}
+
+void benchmark::write_json(std::ostream &stream, std::vector<result> const &results) {
+  /// Write results as a JSON document, for tracking between releases
+  stream << "{\n";
+  stream << "  \"benchmark\": \"vrstorm_input\",\n";
+  #ifdef INPUTSTORM_EQUALITY_COMPARISON_SWITCH
+    stream << "  \"operator_equality\": \"switch\",\n";
+  #else
+    stream << "  \"operator_equality\": \"branch\",\n";
+  #endif // INPUTSTORM_EQUALITY_COMPARISON_SWITCH
+  stream << "  \"counting_allocations\": " << (get_counting_allocations() ? "true" : "false") << ",\n";
+  stream << "  \"results\": [";
+  for(unsigned int i = 0; i != results.size(); ++i) {
+    auto const &this_result(results[i]);
+    stream << (i == 0 ? "\n" : ",\n");
+    stream << "    {\"name\": \"" << this_result.name << "\""
+           << ", \"bindtype\": \"" << this_result.bindtype << "\""
+           << ", \"formulation\": \"" << this_result.formulation << "\""
+           << ", \"controls\": " << this_result.controls
+           << ", \"iterations\": " << this_result.iterations
+           << ", \"nanoseconds_per_call\": " << this_result.nanoseconds_per_call
+           << ", \"calls_per_second\": " << this_result.calls_per_second
+           << ", \"allocations_per_call\": ";
+    if(this_result.allocations_per_call < 0.0) {
+      stream << "null";
+    } else {
+      stream << this_result.allocations_per_call;
+    }
+    stream << "}";
+  }
+  stream << "\n  ]\n";
+  stream << "}\n";
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vrstorm::input {
+
+class benchmark {
+  /// Micro-benchmarks of the controller input dispatch paths and pose inversion, run against the stub runtime so no headset is needed
+public:
+  struct result {
+    std::string name;                                                           // path measured, such as execute_button or binding_set_lookup
+    std::string bindtype;                                                       // binding_button::bindtype of the bindings or lookup key, empty where it doesn't apply
+    std::string formulation;                                                    // binding_button equality or pose inverse formulation, empty where it doesn't apply
+    unsigned int controls = 0;                                                  // controls bound when measured
+    uint64_t iterations = 0;
+    double nanoseconds_per_call = 0.0;
+    double calls_per_second = 0.0;
+    double allocations_per_call = -1.0;                                         // heap allocations, negative if not counted in this build
+  };
+
+  unsigned int iterations = 100000;                                             // timed calls per case, after the warmup
+  unsigned int warmup = 1000;
+  std::vector<unsigned int> control_counts{1, 10, 100};                         // numbers of bound controls to measure each path with
+
+  std::vector<result> run() const;
+
+  static bool get_counting_allocations() __attribute__((__const__));
+  static void write_json(std::ostream &stream, std::vector<result> const &results);
+};
+
+}
@@ -1,4 +1,4 @@
-#include <iostream>
+#include <sstream>
 #include "vrstorm/manager.h"
 
 namespace vrstorm::input {
@@ -33,8 +33,8 @@ void controller::init() {
               ss << " on controller hand " << hand_id;
             }
             ss << " value ";
-            bind_axis(hand, axis, static_cast<axis_direction_type>(axis_direction_id), [s = ss.str()](float value){
-              std::cout << s << std::fixed << value << std::endl;
+            bind_axis(hand, axis, static_cast<axis_direction_type>(axis_direction_id), [this, s = ss.str()](float value){
+              parent.log(logger::level::debug) << s << std::fixed << value;
             });
           }
           */
@@ -54,8 +54,8 @@ void controller::init() {
           }
           ss << " action " << get_actiontype_name(action);
           if(action == actiontype::PRESS) {
-            bind_button(static_cast<hand_type>(hand_id), button, action, [s = ss.str()]{
-              std::cout << s << std::endl;
+            bind_button(static_cast<hand_type>(hand_id), button, action, [this, s = ss.str()]{
+              parent.log(logger::level::debug) << s;
             });
           } else {
             bind_button(static_cast<hand_type>(hand_id), button, action, []{});
@@ -69,12 +69,11 @@ void controller::init() {
 
   // enable all the joysticks by default
   enabled.fill(true);
-  update_hands();
-  update_names();
+  update_hands();                                                               // names them too
 
   // report status
-  std::cout << "VRStorm: Controller axis bindings:   " << sizeof(axis_bindings) / 1024 << "KB" << std::endl;
-  std::cout << "VRStorm: Controller button bindings: " << sizeof(button_bindings) / 1024 << "KB" << std::endl;
+  parent.log(logger::level::info) << "VRStorm: Controller axis bindings:   " << sizeof(axis_bindings) / 1024 << "KB";
+  parent.log(logger::level::info) << "VRStorm: Controller button bindings: " << sizeof(button_bindings) / 1024 << "KB";
 }
 
 inputstorm::input::joystick_axis_bindingtype const &controller::axis_binding_at(hand_type hand,
@@ -84,15 +83,15 @@ inputstorm::input::joystick_axis_bindingtype const &controller::axis_binding_at(
   #ifndef NDEBUG
     // boundary safety check
     if(static_cast<unsigned int>(hand) >= max) {
-      std::cout << "VRStorm: ERROR: attempting to address axis of controller hand " << static_cast<unsigned int>(hand) << " when max is " << max - 1 << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: attempting to address axis of controller hand " << static_cast<unsigned int>(hand) << " when max is " << max - 1;
       return axis_bindings[0][0][0];
     }
     if(axis >= max_axis) {
-      std::cout << "VRStorm: ERROR: attempting to address controller axis number " << axis << " when max is " << max_axis - 1 << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: attempting to address controller axis number " << axis << " when max is " << max_axis - 1;
       return axis_bindings[0][0][0];
     }
     if(static_cast<unsigned int>(axis_direction) >= max_axis_direction) {
-      std::cout << "VRStorm: ERROR: attempting to address controller axis direction " << static_cast<unsigned int>(axis_direction) << " when max is " << max_axis_direction - 1 << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: attempting to address controller axis direction " << static_cast<unsigned int>(axis_direction) << " when max is " << max_axis_direction - 1;
       return axis_bindings[0][0][0];
     }
   #endif // NDEBUG
@@ -105,15 +104,15 @@ std::function<void()> const &controller::button_binding_at(hand_type hand,
   #ifndef NDEBUG
     // boundary safety check
     if(static_cast<unsigned int>(hand) >= max) {
-      std::cout << "VRStorm: ERROR: attempting to address button of controller hand " << static_cast<unsigned int>(hand) << " when max is " << max - 1 << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: attempting to address button of controller hand " << static_cast<unsigned int>(hand) << " when max is " << max - 1;
       return button_bindings[0][0][0];
     }
     if(button >= max_button) {
-      std::cout << "VRStorm: ERROR: attempting to address button number " << button << " when max is " << max_button - 1 << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: attempting to address button number " << button << " when max is " << max_button - 1;
       return button_bindings[0][0][0];
     }
     if(static_cast<unsigned int>(action) > static_cast<unsigned int>(actiontype::LAST)) {
-      std::cout << "VRStorm: ERROR: attempting to address button action " << static_cast<unsigned int>(action) << " when max is " << static_cast<unsigned int>(actiontype::LAST) << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: attempting to address button action " << static_cast<unsigned int>(action) << " when max is " << static_cast<unsigned int>(actiontype::LAST);
       return button_bindings[0][0][0];
     }
   #endif // NDEBUG
@@ -175,16 +174,15 @@ std::string controller::get_name_axis(hand_type hand, unsigned int axis) const {
   #ifndef NDEBUG
     // boundary safety check
     if(axis > vr::Prop_Axis4Type_Int32 - vr::Prop_Axis0Type_Int32) {
-      std::cout << "VRStorm: ERROR: get_name_axis attempting to address controller axis number " << axis << " when max is " << vr::Prop_Axis4Type_Int32 - vr::Prop_Axis0Type_Int32 << std::endl;
+      parent.log(logger::level::error) << "VRStorm: ERROR: get_name_axis attempting to address controller axis number " << axis << " when max is " << vr::Prop_Axis4Type_Int32 - vr::Prop_Axis0Type_Int32;
       return "UNKNOWN";
     }
   #endif // NDEBUG
-  // TODO: cache this with for(unsigned int axis = 0; axis != vr::Prop_Axis4Type_Int32 - vr::Prop_Axis0Type_Int32; ++axis)
   std::stringstream ss;
   unsigned int const controller_id = get_id(hand);
-  switch(parent.hmd_handle->GetInt32TrackedDeviceProperty(controller_id, static_cast<vr::ETrackedDeviceProperty>(vr::Prop_Axis0Type_Int32 + axis))) {
+  switch(parent.get_device_properties(controller_id).axis_types[axis]) {        // cached by the manager, no runtime query
   case vr::k_eControllerAxis_None:
-    //std::cout << "VRStorm: WARNING: OpenVR claims axis " << axis << " on controller " << controller_id << " is of type \"none\"" << std::endl;
+    //parent.log(logger::level::warning) << "VRStorm: WARNING: OpenVR claims axis " << axis << " on controller " << controller_id << " is of type \"none\"";
     ss << "NONE";
     break;
   case vr::k_eControllerAxis_TrackPad:
@@ -219,6 +217,17 @@ std::string controller::get_handtype_name(hand_type hand) {
     return "UNKNOWN";
   }
 }
+controller::hand_type controller::get_hand_from_role(vr::ETrackedControllerRole role) {
+  /// Return the hand corresponding to an openvr controller role
+  switch(role) {
+  case vr::TrackedControllerRole_LeftHand:
+    return hand_type::LEFT;
+  case vr::TrackedControllerRole_RightHand:
+    return hand_type::RIGHT;
+  default:
+    return hand_type::UNKNOWN;
+  }
+}
 std::string controller::get_actiontype_name(actiontype action) {
   /// Return a human-readable name for this controller button actiontype
   switch(action) {
@@ -248,7 +257,7 @@ void controller::bind_axis(hand_type hand,
   /// Bind a function to a controlle axis, with the specified parameters
   #ifndef NDEBUG
     if(!func) {
-      std::cout << "VRStorm: WARNING: Binding a null function to axis " << axis << " on controller hand " << static_cast<unsigned int>(hand) << ", this will throw an exception if called!" << std::endl;
+      parent.log(logger::level::warning) << "VRStorm: WARNING: Binding a null function to axis " << axis << " on controller hand " << static_cast<unsigned int>(hand) << ", this will throw an exception if called!";
     }
   #endif // NDEBUG
   auto &this_binding = axis_bindings[static_cast<unsigned int>(hand)][axis][static_cast<unsigned int>(axis_direction)]; // NOTE: this will contain the already bound axis configuration, which will remember anything not explicitly set here
@@ -299,7 +308,7 @@ void controller::bind_button(hand_type hand,
   /// Bind a function to a controlle button
   #ifndef NDEBUG
     if(!func) {
-      std::cout << "VRStorm: WARNING: Binding a null function to button " << button << " on controller hand " << static_cast<unsigned int>(hand) << ", this will throw an exception if called!" << std::endl;
+      parent.log(logger::level::warning) << "VRStorm: WARNING: Binding a null function to button " << button << " on controller hand " << static_cast<unsigned int>(hand) << ", this will throw an exception if called!";
     }
   #endif // NDEBUG
   button_bindings[static_cast<unsigned int>(action)][static_cast<unsigned int>(hand)][button] = func;
@@ -340,11 +349,11 @@ void controller::bind_button(binding_button const &this_binding,
     if(func_press) {
       bind_button_any(this_binding.hand, func_press);
     } else {
-      std::cout << "VRStorm: Joystick: WARNING - requested to bind to any button with a function other than PRESS on controller hand " << static_cast<unsigned int>(this_binding.hand) << ", this is not currently supported - create a set of specific bindings instead." << std::endl;
+      parent.log(logger::level::warning) << "VRStorm: Joystick: WARNING - requested to bind to any button with a function other than PRESS on controller hand " << static_cast<unsigned int>(this_binding.hand) << ", this is not currently supported - create a set of specific bindings instead.";
     }
     #ifndef NDEBUG
       if(func_release) {
-        std::cout << "VRStorm: WARNING: Requested to bind a function to any button release on controller hand " << static_cast<unsigned int>(this_binding.hand) << ", which is not possible - create a set of specific bindings instead." << std::endl;
+        parent.log(logger::level::warning) << "VRStorm: WARNING: Requested to bind a function to any button release on controller hand " << static_cast<unsigned int>(this_binding.hand) << ", which is not possible - create a set of specific bindings instead.";
       }
     #endif // NDEBUG
     break;
@@ -352,11 +361,11 @@ void controller::bind_button(binding_button const &this_binding,
     if(func_press) {
       bind_button_any_all(func_press);
     } else {
-      std::cout << "VRStorm: Joystick: WARNING - requested to bind to any button on all controllers with a function other than PRESS, this is not currently supported - create a set of specific bindings instead." << std::endl;
+      parent.log(logger::level::warning) << "VRStorm: Joystick: WARNING - requested to bind to any button on all controllers with a function other than PRESS, this is not currently supported - create a set of specific bindings instead.";
     }
     #ifndef NDEBUG
       if(func_release) {
-        std::cout << "VRStorm: WARNING: Requested to bind a function to any button release on all controllers, which is not possible - create a set of specific bindings instead." << std::endl;
+        parent.log(logger::level::warning) << "VRStorm: WARNING: Requested to bind a function to any button release on all controllers, which is not possible - create a set of specific bindings instead.";
       }
     #endif // NDEBUG
     break;
@@ -385,8 +394,8 @@ void controller::unbind_axis(hand_type hand,
         ss << " on controller " << get_name(hand) << " hand " << static_cast<unsigned int>(hand);
       }
       ss << " value ";
-      this_binding.func = [s = ss.str()](float value){
-        std::cout << s << std::fixed << value << std::endl;
+      this_binding.func = [this, s = ss.str()](float value){
+        parent.log(logger::level::debug) << s << std::fixed << value;
       };
       this_binding.enabled = true;
     }
@@ -457,10 +466,10 @@ void controller::execute_axis(hand_type hand,
   }
   #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
     /*
-    std::cout << "VRStorm: DEBUG: executing controller hand " << get_name(hand)
-              << " axis " << get_name_axis(hand, axis) << "(" << axis << ")"
-              << " direction " << static_cast<unsigned int>(axis_direction)
-              << " value " << value << std::endl;
+    parent.log(logger::level::trace) << "VRStorm: TRACE: executing controller hand " << get_name(hand)
+                                     << " axis " << get_name_axis(hand, axis) << "(" << axis << ")"
+                                     << " direction " << static_cast<unsigned int>(axis_direction)
+                                     << " value " << value;
     */
   #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
   this_binding.execute(value);
@@ -474,11 +483,11 @@ void controller::execute_axis(hand_type hand,
 }
 void controller::execute_button(hand_type hand, unsigned int button, actiontype action) {
   /// Call the function associated with a controlle button
-  #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-    std::cout << "VRStorm: DEBUG: executing controller hand " << get_name(hand)
-              << " button " << get_name_button(button) << "(" << button << ")"
-              << " action " << get_actiontype_name(action) << std::endl;
-  #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+  if(parent.log.enabled(logger::level::debug)) {                               // avoid looking up the names unless they'll be logged
+    parent.log(logger::level::debug) << "VRStorm: DEBUG: executing controller hand " << get_name(hand)
+                                     << " button " << get_name_button(button) << "(" << button << ")"
+                                     << " action " << get_actiontype_name(action);
+  }
   button_binding_at(hand, button, action)();
 }
 
@@ -492,7 +501,7 @@ void controller::capture_axis(std::function<void(hand_type,
   static std::array<std::array<std::array<float, max_axis_direction>, max_axis>, max> initial_values;
   if(calibrate || !calibrated) {
     // read the initial values of all axes, and store them for later comparison - some axes may not default to zero, so we need to catch the biggest change
-    std::cout << "VRStorm: Calibrating controller for capture" << std::endl;
+    parent.log(logger::level::info) << "VRStorm: Calibrating controller for capture";
     for(unsigned int hand_id = 0; hand_id != max; ++hand_id) {
       if(!enabled[hand_id]) {
         continue;
@@ -502,12 +511,10 @@ void controller::capture_axis(std::function<void(hand_type,
       for(unsigned int axis = 0; axis != max_axis; ++axis) {
         initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::X)] = controller_state.rAxis[axis].x;
         initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::Y)] = controller_state.rAxis[axis].y;
-        #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-          std::cout << "VRStorm: DEBUG: Calibrated controller hand " << hand_id
-                    << " axis " << axis
-                    << ": " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::X)]
-                    << ", " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::Y)] << std::endl;
-        #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+        parent.log(logger::level::debug) << "VRStorm: DEBUG: Calibrated controller hand " << hand_id
+                                         << " axis " << axis
+                                         << ": " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::X)]
+                                         << ", " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::Y)];
       }
     }
     calibrated = true;
@@ -535,6 +542,7 @@ void controller::capture_axis(std::function<void(hand_type,
                   axis_direction,
                   [callback,
                    #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+                     this,
                      s = ss.str(),
                    #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
                    hand,
@@ -545,12 +553,12 @@ void controller::capture_axis(std::function<void(hand_type,
           float const offset = value - initial_value;
           if(offset > deadzone) {
             #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << s << std::fixed << value << "(offset: pos " << offset << ")" <<  std::endl;
+              parent.log(logger::level::debug) << s << std::fixed << value << "(offset: pos " << offset << ")";
             #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
             callback(hand, axis, axis_direction, false);
           } else if(offset < -deadzone) {
             #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << s << std::fixed << value << "(offset: neg " << offset << ")" <<  std::endl;
+              parent.log(logger::level::debug) << s << std::fixed << value << "(offset: neg " << offset << ")";
             #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
             callback(hand, axis, axis_direction, true);
           }
@@ -566,7 +574,7 @@ void controller::capture_axis(std::function<void(binding_axis const&)> callback,
   static std::array<std::array<std::array<float, max_axis_direction>, max_axis>, max> initial_values;
   if(calibrate || !calibrated) {
     // read the initial values of all axes, and store them for later comparison - some axes may not default to zero, so we need to catch the biggest change
-    std::cout << "VRStorm: Calibrating controller for capture" << std::endl;
+    parent.log(logger::level::info) << "VRStorm: Calibrating controller for capture";
     for(unsigned int hand_id = 0; hand_id != max; ++hand_id) {
       if(!enabled[hand_id]) {
         continue;
@@ -576,12 +584,10 @@ void controller::capture_axis(std::function<void(binding_axis const&)> callback,
       for(unsigned int axis = 0; axis != max_axis; ++axis) {
         initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::X)] = controller_state.rAxis[axis].x;
         initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::Y)] = controller_state.rAxis[axis].y;
-        #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-          std::cout << "VRStorm: DEBUG: Calibrated controller hand " << hand_id
-                    << " axis " << axis
-                    << ": " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::X)]
-                    << ", " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::Y)] << std::endl;
-        #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+        parent.log(logger::level::debug) << "VRStorm: DEBUG: Calibrated controller hand " << hand_id
+                                         << " axis " << axis
+                                         << ": " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::X)]
+                                         << ", " << initial_values[hand_id][axis][static_cast<unsigned int>(axis_direction_type::Y)];
       }
     }
     calibrated = true;
@@ -609,6 +615,7 @@ void controller::capture_axis(std::function<void(binding_axis const&)> callback,
                   axis_direction,
                   [callback,
                    #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+                     this,
                      s = ss.str(),
                    #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
                    hand,
@@ -619,12 +626,12 @@ void controller::capture_axis(std::function<void(binding_axis const&)> callback,
           float const offset = value - initial_value;
           if(offset > deadzone) {
             #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << s << std::fixed << value << "(offset: pos " << offset << ")" <<  std::endl;
+              parent.log(logger::level::debug) << s << std::fixed << value << "(offset: pos " << offset << ")";
             #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
             callback(binding_axis{hand, axis, axis_direction, false, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f});
           } else if(offset < -deadzone) {
             #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << s << std::fixed << value << "(offset: neg " << offset << ")" <<  std::endl;
+              parent.log(logger::level::debug) << s << std::fixed << value << "(offset: neg " << offset << ")";
             #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
             callback(binding_axis{hand, axis, axis_direction, true, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f});
           }
@@ -663,171 +670,201 @@ void controller::capture_button(std::function<void(binding_button const&)> callb
 }
 
 void controller::update_hands() {
-  /// Update the controller ids for the left and right hand
-  bool found_left  = false;
-  bool found_right = false;
-  unsigned int fallback_left  = 0;                                              // defaults for hands if we can't find both
-  unsigned int fallback_right = 0;
-  unsigned int id = 0;                                                          // reused for future loops
-  for(; id != vr::k_unMaxTrackedDeviceCount; ++id) {
-    if(parent.hmd_handle->GetTrackedDeviceClass(id) != vr::TrackedDeviceClass_Controller) {
-      continue;                                                                 // skip non-controllers
-    }
-    switch(parent.hmd_handle->GetControllerRoleForTrackedDeviceIndex(id)) {
-    case vr::TrackedControllerRole_LeftHand:
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: controller id " << id << " is now the left hand (first)." << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      controller_ids[static_cast<unsigned int>(hand_type::LEFT)] = id;
-      enabled[       static_cast<unsigned int>(hand_type::LEFT)] = true;
-      found_left = true;
-      break;
-    case vr::TrackedControllerRole_RightHand:
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: controller id " << id << " is now the right hand (first)." << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      controller_ids[static_cast<unsigned int>(hand_type::RIGHT)] = id;
-      enabled[       static_cast<unsigned int>(hand_type::RIGHT)] = true;
-      found_right = true;
-      break;
-    default:
-      if(fallback_right == 0) {                                                 // assign fallback values, right hand first priority
-        fallback_right = id;
-      } else if(fallback_left == 0) {
-        fallback_left = id;
+  /// Assign controllers to both hands from the device registry, without querying the runtime
+  // the first controller in each role takes that hand, and controllers without a hand role fill any hand left over, right first
+  std::array<unsigned int, max> role_ids{};                                     // zero is the HMD, so means none
+  std::array<unsigned int, 2> fallback_ids{};                                   // right, then left
+  unsigned int fallback_count = 0;
+  for(uint64_t remaining = parent.devices.get_class_mask(vr::TrackedDeviceClass_Controller); remaining != 0; remaining &= remaining - 1) {
+    unsigned int const id = static_cast<unsigned int>(__builtin_ctzll(remaining));
+    hand_type const hand = parent.devices.get_hand(id);
+    if(hand != hand_type::UNKNOWN) {
+      if(role_ids[static_cast<unsigned int>(hand)] == 0) {
+        role_ids[static_cast<unsigned int>(hand)] = id;
       }
-      break;
+    } else if(fallback_count != fallback_ids.size()) {
+      fallback_ids[fallback_count] = id;
+      ++fallback_count;
+    }
+  }
+  unsigned int fallback_used = 0;
+  for(auto const hand : {hand_type::RIGHT, hand_type::LEFT}) {
+    if(role_ids[static_cast<unsigned int>(hand)] != 0) {
+      set_hand(hand, role_ids[static_cast<unsigned int>(hand)], false);
+    } else if(fallback_used != fallback_count) {
+      set_hand(hand, fallback_ids[fallback_used], true);
+      ++fallback_used;
+    } else {
+      clear_hand(hand);
+    }
+  }
+}
+void controller::add_device(unsigned int id) {
+  /// Give a newly registered controller a hand if it has that role, or if a hand has none
+  if(parent.devices.get_class(id) != vr::TrackedDeviceClass_Controller) {
+    return;
+  }
+  hand_type const hand = parent.devices.get_hand(id);
+  if(hand != hand_type::UNKNOWN) {
+    if(!get_enabled(hand) || guessed[static_cast<unsigned int>(hand)]) {        // a controller in the right role replaces a guess
+      set_hand(hand, id, false);
     }
+    return;
   }
-  // this is an optimisation to reduce the number of comparisons and avoid searching further than we have to
-  if(found_left) {
-    if(found_right) {
+  for(auto const fallback_hand : {hand_type::RIGHT, hand_type::LEFT}) {
+    if(!get_enabled(fallback_hand)) {
+      set_hand(fallback_hand, id, true);
       return;
     }
-    for(; id != vr::k_unMaxTrackedDeviceCount; ++id) {                          // resume the loop
-      if(parent.hmd_handle->GetTrackedDeviceClass(id) != vr::TrackedDeviceClass_Controller) {
-        continue;                                                               // skip non-controllers
-      }
-      if(parent.hmd_handle->GetControllerRoleForTrackedDeviceIndex(id) == vr::TrackedControllerRole_RightHand) {
-        #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-          std::cout << "VRStorm: DEBUG: controller id " << id << " is now the right hand (second)." << std::endl;
-        #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        controller_ids[static_cast<unsigned int>(hand_type::RIGHT)] = id;
-        enabled[       static_cast<unsigned int>(hand_type::RIGHT)] = true;
-        return;
-      }
-      if(fallback_right == 0) {                                                 // assign fallback values, we've already found the left
-        fallback_right = id;
-      }
+  }
+}
+void controller::remove_device(unsigned int id) {
+  /// Find replacements for any hand a controller held, once it has left the device registry
+  for(auto const hand : {hand_type::LEFT, hand_type::RIGHT}) {
+    if(get_enabled(hand) && get_id(hand) == id) {
+      find_hand(hand);
     }
-    controller_ids[static_cast<unsigned int>(hand_type::RIGHT)] = fallback_right;
-    if(fallback_right == 0) {
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: could not find a controller for the right hand." << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      enabled[static_cast<unsigned int>(hand_type::RIGHT)] = false;
-    } else {
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: could not find a controller for the right hand, guessing it's id " << fallback_right << "." << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      enabled[static_cast<unsigned int>(hand_type::RIGHT)] = true;
+  }
+}
+void controller::update_device(unsigned int id) {
+  /// Reassign hands after a controller's role in the device registry may have changed
+  if(parent.devices.get_class(id) != vr::TrackedDeviceClass_Controller) {
+    return;
+  }
+  hand_type const new_hand = parent.devices.get_hand(id);
+  for(auto const hand : {hand_type::LEFT, hand_type::RIGHT}) {
+    if(get_enabled(hand) && get_id(hand) == id) {
+      update_axis_mask(hand);                                                   // its axes may have changed with its properties
     }
-  } else if(found_right) {
-    for(; id != vr::k_unMaxTrackedDeviceCount; ++id) {                          // resume the loop
-      if(parent.hmd_handle->GetTrackedDeviceClass(id) != vr::TrackedDeviceClass_Controller) {
-        continue;                                                               // skip non-controllers
-      }
-      if(parent.hmd_handle->GetControllerRoleForTrackedDeviceIndex(id) == vr::TrackedControllerRole_LeftHand) {
-        #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-          std::cout << "VRStorm: DEBUG: controller id " << id << " is now the left hand (second)." << std::endl;
-        #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        controller_ids[static_cast<unsigned int>(hand_type::LEFT)] = id;
-        enabled[       static_cast<unsigned int>(hand_type::LEFT)] = true;
+    if(hand != new_hand && get_enabled(hand) && get_id(hand) == id && !guessed[static_cast<unsigned int>(hand)]) {
+      find_hand(hand);                                                          // it held this hand by role, and no longer does
+    }
+  }
+  if(new_hand != hand_type::UNKNOWN && (get_id(new_hand) != id || guessed[static_cast<unsigned int>(new_hand)])) {
+    for(auto const other_hand : {hand_type::LEFT, hand_type::RIGHT}) {
+      if(other_hand != new_hand && get_enabled(other_hand) && get_id(other_hand) == id) {
+        clear_hand(other_hand);                                                 // it was only a guess for the other hand
+        set_hand(new_hand, id, false);
+        find_hand(other_hand);
         return;
       }
-      if(fallback_left == 0) {                                                  // assign fallback values, we've already found the right
-        fallback_left = id;
-      }
     }
-    controller_ids[static_cast<unsigned int>(hand_type::LEFT)] = fallback_left;
-    if(fallback_left == 0) {
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: could not find a controller for the right hand." << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      enabled[static_cast<unsigned int>(hand_type::LEFT)] = false;
-    } else {
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: could not find a controller for the left hand, guessing it's id " << fallback_right << "." << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      enabled[static_cast<unsigned int>(hand_type::LEFT)] = true;
+    set_hand(new_hand, id, false);
+  }
+}
+
+void controller::find_hand(hand_type hand) {
+  /// Search the registered controllers for one to take a hand, preferring one in that role
+  hand_type const other_hand = hand == hand_type::LEFT ? hand_type::RIGHT : hand_type::LEFT;
+  unsigned int fallback_id = 0;
+  for(uint64_t remaining = parent.devices.get_class_mask(vr::TrackedDeviceClass_Controller); remaining != 0; remaining &= remaining - 1) {
+    unsigned int const id = static_cast<unsigned int>(__builtin_ctzll(remaining));
+    if(get_enabled(other_hand) && get_id(other_hand) == id) {
+      continue;                                                                 // already holding the other hand
+    }
+    hand_type const this_hand = parent.devices.get_hand(id);
+    if(this_hand == hand) {
+      set_hand(hand, id, false);
+      return;
     }
-  } else {
-    controller_ids[static_cast<unsigned int>(hand_type::LEFT )] = fallback_left;
-    controller_ids[static_cast<unsigned int>(hand_type::RIGHT)] = fallback_right;
-    #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      std::cout << "VRStorm: DEBUG: could not find any controllers for either hand";
-    #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-    if(fallback_left == 0) {
-      enabled[static_cast<unsigned int>(hand_type::LEFT)] = false;
-    } else {
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << ", guessing left is id " << fallback_left;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      enabled[static_cast<unsigned int>(hand_type::LEFT)] = true;
+    if(this_hand == hand_type::UNKNOWN && fallback_id == 0) {
+      fallback_id = id;
     }
-    if(fallback_right == 0) {
-      enabled[static_cast<unsigned int>(hand_type::RIGHT)] = false;
-    } else {
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << ", guessing right is id " << fallback_right;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      enabled[static_cast<unsigned int>(hand_type::RIGHT)] = true;
-    }
-    #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      std::cout << "." << std::endl;
-    #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+  }
+  if(fallback_id == 0) {
+    clear_hand(hand);
+  } else {
+    set_hand(hand, fallback_id, true);
+  }
+}
+void controller::set_hand(hand_type hand, unsigned int id, bool guess) {
+  /// Assign a controller to a hand, renaming it only if it changed
+  unsigned int const hand_id = static_cast<unsigned int>(hand);
+  if(enabled[hand_id] && controller_ids[hand_id] == id && guessed[hand_id] == guess && !names[hand_id].empty()) {
+    update_axis_mask(hand);                                                     // its axes may have changed with its properties
+    return;
+  }
+  if(guess) {
+    parent.log(logger::level::debug) << "VRStorm: DEBUG: could not find a controller for the " << get_handtype_name(hand) << " hand, guessing it's id " << id << ".";
+  } else {
+    parent.log(logger::level::debug) << "VRStorm: DEBUG: controller id " << id << " is now the " << get_handtype_name(hand) << " hand.";
+  }
+  controller_ids[hand_id] = id;
+  enabled[hand_id] = true;
+  guessed[hand_id] = guess;
+  polled[hand_id] = false;                                                      // always dispatch the new controller's first packet
+  update_axis_mask(hand);
+  update_name(hand);
+}
+void controller::clear_hand(hand_type hand) {
+  /// Leave a hand without a controller
+  unsigned int const hand_id = static_cast<unsigned int>(hand);
+  if(!enabled[hand_id] && controller_ids[hand_id] == 0) {
     return;
   }
+  parent.log(logger::level::debug) << "VRStorm: DEBUG: could not find a controller for the " << get_handtype_name(hand) << " hand.";
+  controller_ids[hand_id] = 0;
+  enabled[hand_id] = false;
+  guessed[hand_id] = false;
+  axis_masks[hand_id] = 0;
+  names[hand_id].clear();
+}
+void controller::update_axis_mask(hand_type hand) {
+  /// Cache which axes are present on a hand's controller, from the properties read when it activated
+  axis_masks[static_cast<unsigned int>(hand)] = parent.get_device_properties(get_id(hand)).axis_mask;
 }
 
+void controller::update_name(hand_type hand) {
+  /// Update the name of one controller
+  if(!get_enabled(hand)) {
+    names[static_cast<unsigned int>(hand)].clear();
+    return;
+  }
+  std::string const suffix(hand == hand_type::LEFT ? " (left)" : " (right)");
+  names[static_cast<unsigned int>(hand)] = parent.get_device_properties(get_id(hand)).model_number + suffix;
+  parent.log(logger::level::debug) << "VRStorm: DEBUG: controller: " << get_handtype_name(hand) << " is \"" << get_name(hand) << "\"";
+}
 void controller::update_names() {
   /// Update the list of controller names
-  names[static_cast<unsigned int>(hand_type::LEFT )] = parent.get_tracked_device_string(get_id(hand_type::LEFT),  vr::Prop_ModelNumber_String) + " (left)";
-  names[static_cast<unsigned int>(hand_type::RIGHT)] = parent.get_tracked_device_string(get_id(hand_type::RIGHT), vr::Prop_ModelNumber_String) + " (right)";
-  #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-    std::cout << "VRStorm: DEBUG: controller: left is  \"" << get_name(hand_type::LEFT) << "\"" << std::endl;
-    std::cout << "VRStorm: DEBUG: controller: right is \"" << get_name(hand_type::RIGHT) << "\"" << std::endl;
-  #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+  update_name(hand_type::LEFT);
+  update_name(hand_type::RIGHT);
 }
 
 void controller::poll() {
   /// Poll and update the analogue controller axes for the known hands
   for(auto const hand : std::initializer_list<hand_type>{hand_type::LEFT, hand_type::RIGHT}) { // iterate through the list of acceptable hands
     if(get_enabled(hand)) {
+      unsigned int const hand_id = static_cast<unsigned int>(hand);
       vr::VRControllerState_t controller_state;
       unsigned int controller_id = get_id(hand);
       parent.hmd_handle->GetControllerState(controller_id, &controller_state);
+      parent.recorder.record_controller_state(controller_id, controller_state);
+      if(skip_unchanged && polled[hand_id] && controller_state.unPacketNum == last_packet_nums[hand_id]) {
+        continue;                                                               // nothing has changed since the last dispatch
+      }
+      polled[hand_id] = true;
+      last_packet_nums[hand_id] = controller_state.unPacketNum;
       #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
         /*
-        std::cout << "VRStorm: DEBUG: controller id " << controller_id
-                  << " hand " << get_name(hand)
-                  << " unPacketNum " << controller_state.unPacketNum
-                  << " ulButtonPressed " << controller_state.ulButtonPressed
-                  << " ulButtonTouched " << controller_state.ulButtonTouched << std::endl;
+        parent.log(logger::level::trace) << "VRStorm: TRACE: controller id " << controller_id
+                                         << " hand " << get_name(hand)
+                                         << " unPacketNum " << controller_state.unPacketNum
+                                         << " ulButtonPressed " << controller_state.ulButtonPressed
+                                         << " ulButtonTouched " << controller_state.ulButtonTouched;
         */
       #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      for(unsigned int axis = 0; axis != max_axis; ++axis) {
+      for(uint32_t remaining = axis_masks[hand_id]; remaining != 0; remaining &= remaining - 1) { // only the axes this controller has
+        unsigned int const axis = static_cast<unsigned int>(__builtin_ctz(remaining));
         #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
           /*
           if(controller_state.rAxis[axis].x != 0.0f && controller_state.rAxis[axis].y != 0.0f) {
-            std::cout << "VRStorm: DEBUG: axis " << axis
-                      << " value " << controller_state.rAxis[axis].x
-                      << ", " << controller_state.rAxis[axis].y << std::endl;
+            parent.log(logger::level::trace) << "VRStorm: TRACE: axis " << axis
+                                             << " value " << controller_state.rAxis[axis].x
+                                             << ", " << controller_state.rAxis[axis].y;
           }
           */
         #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
         execute_axis(hand, axis, {controller_state.rAxis[axis].x, controller_state.rAxis[axis].y});
-        // TODO: maintain a list of axes that are present for the present controller, and only poll those.  Update them when the controller changes
       }
     }
   }
@@ -836,26 +873,28 @@ void controller::poll(unsigned int controller_id) {
   /// Poll and update the analogue controller axes for a given controller id
   vr::VRControllerState_t controller_state;
   parent.hmd_handle->GetControllerState(controller_id, &controller_state);
+  uint32_t const axis_mask = parent.get_device_properties(controller_id).axis_mask;
   switch(parent.hmd_handle->GetControllerRoleForTrackedDeviceIndex(controller_id)) {
   case vr::TrackedControllerRole_LeftHand:
     if(get_enabled(hand_type::LEFT)) {
       #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
         /*
-        std::cout << "VRStorm: DEBUG: controller left id " << controller_id
-                  << " hand " << get_name(hand_type::LEFT)
-                  << " unPacketNum " << controller_state.unPacketNum
-                  << " ulButtonPressed " << controller_state.ulButtonPressed
-                  << " ulButtonTouched " << controller_state.ulButtonTouched << std::endl;
+        parent.log(logger::level::trace) << "VRStorm: TRACE: controller left id " << controller_id
+                                         << " hand " << get_name(hand_type::LEFT)
+                                         << " unPacketNum " << controller_state.unPacketNum
+                                         << " ulButtonPressed " << controller_state.ulButtonPressed
+                                         << " ulButtonTouched " << controller_state.ulButtonTouched;
         */
       #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
       controller_ids[static_cast<unsigned int>(input::controller::hand_type::LEFT)] = controller_id; // opportunity to update the controller ids here for free
-      for(unsigned int axis = 0; axis != max_axis; ++axis) {
+      for(uint32_t remaining = axis_mask; remaining != 0; remaining &= remaining - 1) { // only the axes this controller has
+        unsigned int const axis = static_cast<unsigned int>(__builtin_ctz(remaining));
         #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
           /*
           if(controller_state.rAxis[axis].x != 0.0f && controller_state.rAxis[axis].y != 0.0f) {
-            std::cout << "VRStorm: DEBUG: axis " << axis
-                      << " value " << controller_state.rAxis[axis].x
-                      << ", " << controller_state.rAxis[axis].y << std::endl;
+            parent.log(logger::level::trace) << "VRStorm: TRACE: axis " << axis
+                                             << " value " << controller_state.rAxis[axis].x
+                                             << ", " << controller_state.rAxis[axis].y;
           }
           */
         #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
@@ -867,21 +906,22 @@ void controller::poll(unsigned int controller_id) {
     if(get_enabled(hand_type::LEFT)) {
       #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
         /*
-        std::cout << "VRStorm: DEBUG: controller right id " << controller_id
-                  << " hand " << get_name(hand_type::LEFT)
-                  << " unPacketNum " << controller_state.unPacketNum
-                  << " ulButtonPressed " << controller_state.ulButtonPressed
-                  << " ulButtonTouched " << controller_state.ulButtonTouched << std::endl;
+        parent.log(logger::level::trace) << "VRStorm: TRACE: controller right id " << controller_id
+                                         << " hand " << get_name(hand_type::LEFT)
+                                         << " unPacketNum " << controller_state.unPacketNum
+                                         << " ulButtonPressed " << controller_state.ulButtonPressed
+                                         << " ulButtonTouched " << controller_state.ulButtonTouched;
         */
       #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
       controller_ids[static_cast<unsigned int>(input::controller::hand_type::RIGHT)] = controller_id; // opportunity to update the controller ids here for free
-      for(unsigned int axis = 0; axis != max_axis; ++axis) {
+      for(uint32_t remaining = axis_mask; remaining != 0; remaining &= remaining - 1) { // only the axes this controller has
+        unsigned int const axis = static_cast<unsigned int>(__builtin_ctz(remaining));
         #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
           /*
           if(controller_state.rAxis[axis].x != 0.0f && controller_state.rAxis[axis].y != 0.0f) {
-            std::cout << "VRStorm: DEBUG: axis " << axis
-                      << " value " << controller_state.rAxis[axis].x
-                      << ", " << controller_state.rAxis[axis].y << std::endl;
+            parent.log(logger::level::trace) << "VRStorm: TRACE: axis " << axis
+                                             << " value " << controller_state.rAxis[axis].x
+                                             << ", " << controller_state.rAxis[axis].y;
           }
           */
         #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
@@ -890,8 +930,9 @@ void controller::poll(unsigned int controller_id) {
     }
     break;
   default:
-    std::cout << "VRStorm: WARNING: axis failed to poll on unknown hand " << static_cast<int>(parent.hmd_handle->GetControllerRoleForTrackedDeviceIndex(controller_id))
-              << " for controller id " << controller_id << std::endl;
+    static logger::rate_limit unknown_hand_limit;
+    parent.log(logger::level::warning, unknown_hand_limit) << "VRStorm: WARNING: axis failed to poll on unknown hand " << static_cast<int>(parent.hmd_handle->GetControllerRoleForTrackedDeviceIndex(controller_id))
+                                                           << " for controller id " << controller_id;
     break;
   }
 }
@@ -904,9 +945,10 @@ void controller::draw_binding_graphs() const {
         if(!this_binding.enabled) {
           continue;
         }
-        std::cout << "VRStorm: Transform function on controller " << get_name(static_cast<hand_type>(hand_id))
-                  << " axis " << axis
-                  << " direction " << direction_id << ":" << std::endl;
+        parent.log(logger::level::info) << "VRStorm: Transform function on controller " << get_name(static_cast<hand_type>(hand_id))
+                                        << " axis " << axis
+                                        << " direction " << direction_id << ":";
+        parent.log.flush();                                                     // the graph is drawn straight to the console, so keep it in order
         this_binding.draw_graph_console();
       }
     }
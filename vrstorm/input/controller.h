@@ -62,42 +62,51 @@ public:
 
     bool operator==(const binding_button &rhs) const {
       /// Equality operator
-      // two formulations with the same effect - benchmark to see which performs best in each specific use case
+      // two formulations with the same effect - benchmark to see which performs best in each specific use case, see input::benchmark
       #ifdef INPUTSTORM_EQUALITY_COMPARISON_SWITCH
-        switch(type) {
+        return equals_switch(rhs);
+      #else
+        return equals_branch(rhs);
+      #endif // INPUTSTORM_EQUALITY_COMPARISON_SWITCH
+    }
+    bool equals_switch(const binding_button &rhs) const {
+      /// Equality formulation nesting a switch on each side's bindtype
+      switch(type) {
+      case bindtype::SPECIFIC:
+        switch(rhs.type) {
         case bindtype::SPECIFIC:
-          switch(rhs.type) {
-          case bindtype::SPECIFIC:
-            return (hand == rhs.hand) && (button == rhs.button);
-          case bindtype::ANY:
-            return hand == rhs.hand;
-          case bindtype::ANY_ALL:
-            return true;
-          }
-          break;
+          return (hand == rhs.hand) && (button == rhs.button);
         case bindtype::ANY:
-          switch(rhs.type) {
-          case bindtype::SPECIFIC:
-          case bindtype::ANY:
-            return hand == rhs.hand;
-          case bindtype::ANY_ALL:
-            return true;
-          }
-          break;
+          return hand == rhs.hand;
         case bindtype::ANY_ALL:
           return true;
-        default:
-          return false;
         }
-      #else
-        if(type == bindtype::ANY_ALL || rhs.type == bindtype::ANY_ALL) {
-          return true;
-        } else if(type == bindtype::ANY || rhs.type == bindtype::ANY) {
+        break;
+      case bindtype::ANY:
+        switch(rhs.type) {
+        case bindtype::SPECIFIC:
+        case bindtype::ANY:
           return hand == rhs.hand;
-        } else {
-          return (hand == rhs.hand) && (button == rhs.button);
+        case bindtype::ANY_ALL:
+          return true;
         }
-      #endif // INPUTSTORM_EQUALITY_COMPARISON_SWITCH
+        break;
+      case bindtype::ANY_ALL:
+        return true;
+      default:
+        return false;
+      }
+      return false;
+    }
+    bool equals_branch(const binding_button &rhs) const {
+      /// Equality formulation testing the widest wildcard first
+      if(type == bindtype::ANY_ALL || rhs.type == bindtype::ANY_ALL) {
+        return true;
+      } else if(type == bindtype::ANY || rhs.type == bindtype::ANY) {
+        return hand == rhs.hand;
+      } else {
+        return (hand == rhs.hand) && (button == rhs.button);
+      }
     }
 
     size_t hash_value() const {
@@ -118,10 +127,16 @@ private:
   std::array<bool, max> enabled;                                                // whether each controller is enabled or not
   std::array<std::string, max> names;                                           // cached human-readable names of controllers
   std::array<unsigned int, max> controller_ids;                                 // cached openvr controller id for each hand
+  std::array<bool, max> guessed{};                                              // whether each hand's controller was picked without being in that role
+  std::array<uint32_t, max> axis_masks{};                                       // bit per axis present on each hand's controller, the only axes polled
+  std::array<uint32_t, max> last_packet_nums{};                                 // controller state packet each hand was last dispatched from
+  std::array<bool, max> polled{};                                               // false until a hand's controller has been dispatched from once
   std::array<std::array<std::array<inputstorm::input::joystick_axis_bindingtype, max_axis_direction>, max_axis>, max> axis_bindings; // callback functions for controller axes
   std::array<std::array<std::array<std::function<void()>, max_button>, max>, static_cast<int>(actiontype::END)> button_bindings; // callback functions for controller buttons
 
 public:
+  bool skip_unchanged = true;                                                   // poll() only dispatches axes when the controller state packet has changed, so held values aren't repeated
+
   controller(manager &this_parent);
   ~controller();
 
@@ -142,6 +157,7 @@ public:
   std::string get_name_axis(hand_type hand, unsigned int axis) const;
   unsigned int get_id(hand_type hand) const __attribute__((__pure__));
   static std::string get_handtype_name(hand_type hand);
+  static hand_type get_hand_from_role(vr::ETrackedControllerRole role) __attribute__((__const__));
   static std::string get_actiontype_name(actiontype action);
 
   void bind_axis(          hand_type hand,
@@ -206,8 +222,20 @@ public:
   void capture_button(std::function<void(binding_button const&  )> callback);
 
   void update_hands();
+  void add_device(   unsigned int id);
+  void remove_device(unsigned int id);
+  void update_device(unsigned int id);
   void update_names();
 
+private:
+  void find_hand(  hand_type hand);
+  void set_hand(   hand_type hand, unsigned int id, bool guess);
+  void clear_hand( hand_type hand);
+  void update_name(hand_type hand);
+  void update_axis_mask(hand_type hand);
+
+public:
+
   void poll();
   void poll(unsigned int controller_id);
 
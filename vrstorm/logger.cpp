@@ -0,0 +1,167 @@
+#include "logger.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace vrstorm {
+
+logger::rate_limit::rate_limit(unsigned int this_per_second)
+  : per_second(this_per_second) {
+  /// Default constructor
+}
+
+bool logger::rate_limit::allow(unsigned int &suppressed_out) {
+  /// Return whether a message may be logged now, and how many were suppressed since the last one allowed
+  int64_t const now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  int64_t start = window_start.load(std::memory_order_relaxed);
+  if(now - start >= 1000 && window_start.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+    count.store(0, std::memory_order_relaxed);                                  // this thread opened a new window
+  }
+  if(count.fetch_add(1, std::memory_order_relaxed) >= per_second) {
+    suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  suppressed_out = suppressed.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+logger::message_buffer::message_buffer() {
+  /// Default constructor
+  setp(text.data(), text.data() + text.size());                                 // writes past the end fail, truncating the message
+}
+
+logger::message::message(logger *this_parent, unsigned int this_suppressed)
+  : std::ostream(this_parent ? static_cast<std::streambuf*>(this) : nullptr),   // a null buffer sets badbit, so every write is a no-op
+    parent(this_parent),
+    suppressed(this_suppressed) {
+  /// Default constructor
+}
+logger::message::~message() {
+  /// Queue the formatted message, if it's enabled
+  if(!parent) {
+    return;
+  }
+  if(suppressed != 0) {
+    clear();                                                                    // a truncated message still gets the count if there's room
+    *this << " (" << suppressed << " similar suppressed)";
+  }
+  parent->push(pbase(), static_cast<unsigned int>(pptr() - pbase()));
+}
+
+logger::logger() {
+  /// Default constructor
+  for(unsigned int i = 0; i != size; ++i) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  writer_thread = std::thread(&logger::writer_loop, this);
+}
+logger::~logger() {
+  /// Default destructor, writes out anything still queued
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    writer_running = false;
+  }
+  writer_wake.notify_one();
+  writer_thread.join();
+}
+
+logger::message logger::operator()(level message_level) {
+  /// Start a message at the given level, which is discarded if that level is disabled
+  return message(enabled(message_level) ? this : nullptr);
+}
+logger::message logger::operator()(level message_level, rate_limit &limit) {
+  /// Start a message at the given level, which is discarded if that level is disabled or the limit is exceeded
+  if(!enabled(message_level)) {
+    return message(nullptr);                                                    // disabled messages don't count towards the limit
+  }
+  unsigned int suppressed = 0;
+  if(!limit.allow(suppressed)) {
+    return message(nullptr);
+  }
+  return message(this, suppressed);
+}
+
+bool logger::enabled(level message_level) const {
+  /// Return whether messages at the given level are currently being logged
+  return message_level <= max_level.load(std::memory_order_relaxed);
+}
+void logger::set_level(level new_level) {
+  /// Log messages at this level and more severe, from now on
+  max_level.store(new_level, std::memory_order_relaxed);
+}
+logger::level logger::get_level() const {
+  /// Return the least severe level currently being logged
+  return max_level.load(std::memory_order_relaxed);
+}
+
+void logger::flush() {
+  /// Block until everything queued before this call has been written out
+  uint64_t const target = write_position.load(std::memory_order_acquire);
+  while(read_position.load(std::memory_order_acquire) < target) {
+    writer_wake.notify_one();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void logger::push(char const *text, unsigned int length) {
+  /// Copy a formatted message into the queue, or drop it if the queue is full - never blocks
+  uint64_t position = write_position.load(std::memory_order_relaxed);
+  slot *this_slot;
+  for(;;) {
+    this_slot = &slots[position % size];
+    uint64_t const sequence = this_slot->sequence.load(std::memory_order_acquire);
+    if(sequence == position) {
+      if(write_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;                                                                  // this slot is ours to fill
+      }
+    } else if(sequence < position) {
+      dropped.fetch_add(1, std::memory_order_relaxed);                          // the writer hasn't freed this slot yet, so the queue is full
+      return;
+    } else {
+      position = write_position.load(std::memory_order_relaxed);                // another thread took this slot
+    }
+  }
+  std::memcpy(this_slot->text.data(), text, length);
+  this_slot->length = length;
+  this_slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool logger::drain() {
+  /// Write out every queued message in order; returns whether anything was written
+  bool written = false;
+  for(;;) {
+    uint64_t const position = read_position.load(std::memory_order_relaxed);
+    slot &this_slot = slots[position % size];
+    if(this_slot.sequence.load(std::memory_order_acquire) != position + 1) {
+      break;                                                                    // empty, or the next message is still being copied in
+    }
+    std::cout.write(this_slot.text.data(), this_slot.length);
+    std::cout.put('\n');
+    this_slot.sequence.store(position + size, std::memory_order_release);       // free the slot for the next lap
+    read_position.store(position + 1, std::memory_order_release);
+    written = true;
+  }
+  if(unsigned int const dropped_count = dropped.exchange(0, std::memory_order_relaxed)) {
+    std::cout << "VRStorm: WARNING: log queue was full, " << dropped_count << " messages dropped" << '\n';
+    written = true;
+  }
+  if(written) {
+    std::cout.flush();                                                          // one flush per batch, never on the caller's thread
+  }
+  return written;
+}
+
+void logger::writer_loop() {
+  /// Background thread that writes out queued messages until the logger is destroyed
+  std::unique_lock<std::mutex> lock(writer_mutex);
+  while(writer_running) {
+    lock.unlock();
+    drain();
+    lock.lock();
+    writer_wake.wait_for(lock, std::chrono::milliseconds(10));                  // producers never lock or notify, so poll
+  }
+  lock.unlock();
+  drain();
+}
+
+}
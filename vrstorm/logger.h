@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+
+namespace vrstorm {
+
+class logger {
+  /// Bounded lock-free log queue, written from any thread without blocking and drained to std::cout by a background thread
+public:
+  enum class level : char {
+    error,                                                                      // lower case, as ERROR and DEBUG are often macros
+    warning,
+    info,
+    debug,
+    trace                                                                       // per-frame detail, very verbose
+  };
+
+  static unsigned int constexpr size = 1024;                                    // messages held before new ones are dropped
+  static unsigned int constexpr message_length = 256;                           // longer messages are truncated
+
+  class rate_limit {
+    /// Limit on how often one message is logged, declared static at the call site
+    std::atomic<int64_t> window_start{0};                                       // milliseconds on the steady clock
+    std::atomic<unsigned int> count{0};                                         // messages so far in this window
+    std::atomic<unsigned int> suppressed{0};                                    // messages dropped since the last one allowed through
+
+  public:
+    unsigned int const per_second;
+
+    explicit rate_limit(unsigned int this_per_second = 1);
+
+    bool allow(unsigned int &suppressed_out);
+  };
+
+private:
+  class message_buffer : public std::streambuf {
+    /// Fixed-size buffer on the caller's stack, so formatting a message never allocates
+  protected:
+    std::array<char, message_length> text;
+
+    message_buffer();
+  };
+
+public:
+  class message : private message_buffer, public std::ostream {
+    /// One line being formatted, queued when it goes out of scope; writes are discarded if its level is disabled
+    logger *parent;                                                             // null if disabled or rate limited
+    unsigned int suppressed;                                                    // similar messages dropped by the rate limit before this one
+
+  public:
+    message(logger *this_parent, unsigned int this_suppressed = 0);
+    message(message const&) = delete;
+    ~message();
+  };
+
+private:
+  struct slot {
+    std::atomic<uint64_t> sequence{0};                                          // equals the write position when free, one past it when filled
+    unsigned int length = 0;
+    std::array<char, message_length> text;
+  };
+
+  std::array<slot, size> slots;
+  std::atomic<uint64_t> write_position{0};
+  std::atomic<uint64_t> read_position{0};                                       // only advanced by the writer thread
+  #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+    std::atomic<level> max_level{level::debug};                                 // the debug build flags only set the starting level
+  #else
+    std::atomic<level> max_level{level::info};
+  #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
+  std::atomic<unsigned int> dropped{0};                                         // messages lost because the queue was full
+
+  std::thread writer_thread;
+  std::mutex writer_mutex;
+  std::condition_variable writer_wake;
+  bool writer_running = true;                                                   // guarded by writer_mutex
+
+public:
+  logger();
+  ~logger();
+
+  message operator()(level message_level);
+  message operator()(level message_level, rate_limit &limit);
+
+  bool enabled(level message_level) const __attribute__((__pure__));
+  void set_level(level new_level);
+  level get_level() const __attribute__((__pure__));
+
+  void flush();
+
+private:
+  void push(char const *text, unsigned int length);
+  bool drain();
+  void writer_loop();
+};
+
+}
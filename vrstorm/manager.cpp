@@ -1,14 +1,28 @@
 #include "vrstorm.h"
-#include <iostream>
-#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include "dynamic_load.h"
 #include "vectorstorm/vector/vector3.h"
 
 namespace vrstorm {
 
+namespace {
+
+float milliseconds_since(std::chrono::steady_clock::time_point start) {
+  /// Return the time elapsed since a start point, in milliseconds
+  return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
 manager::manager()
   : input_controller(*this) {
   /// Default constructor
+  #ifndef VRSTORM_DISABLED
+    init_event_handlers();
+  #endif // VRSTORM_DISABLED
 }
 
 manager::~manager() {
@@ -16,214 +30,303 @@ manager::~manager() {
   shutdown();
 }
 
-void manager::init() {
-  /// Initialise the virtual reality system
+void manager::init(backend_type this_backend
+                     #ifdef VRSTORM_DISABLED
+                       [[maybe_unused]]
+                     #endif // VRSTORM_DISABLED
+                   ) {
+  /// Initialise the virtual reality system, leaving anything the first frame doesn't need to the next update
   #ifndef VRSTORM_DISABLED
     try {
-      // dynamic library load
-      #if defined(PLATFORM_WINDOWS)
-        #ifdef PLATFORM_64BIT
-          lib = load_dynamic({"./openvr_api64.dll", "openvr_api64.dll", "./openvr_api.dll", "openvr_api.dll"});
-        #else
-          lib = load_dynamic({"./openvr_api.dll", "openvr_api.dll"});
-        #endif // PLATFORM_64BIT
-      #elif defined(PLATFORM_LINUX)
-        #ifdef PLATFORM_64BIT
-          #ifdef NDEBUG
-            lib = load_dynamic({"./libopenvr_api.so", "libopenvr_api.so"});
+      init_timings.clear();
+      auto const time_start(std::chrono::steady_clock::now());
+      auto time_phase(time_start);
+      auto const end_phase = [&](char const *name){                             // record how long each phase of startup took
+        auto const time_now(std::chrono::steady_clock::now());
+        init_timings.push_back({name, std::chrono::duration<float, std::milli>(time_now - time_phase).count()});
+        time_phase = time_now;
+      };
+
+      backend = this_backend;
+      if(backend == backend_type::REPLAY) {
+        if(!replay.open(replay_path)) {
+          log(logger::level::error) << "VRStorm: Unable to open session log \"" << replay_path << "\" for replay.";
+          shutdown();
+          return;
+        }
+        stub.load(symbols, &replay);                                            // the stub stands in for the runtime, serving recorded frames
+        log(logger::level::info) << "VRStorm: Replaying " << replay.get_frame_count() << " frames from session log \"" << replay_path << "\".";
+      } else if(backend == backend_type::STUB) {
+        stub.load(symbols);                                                     // entry points are served in-process, there's no library to load
+        log(logger::level::info) << "VRStorm: Using the built-in stub runtime.";
+      } else {
+        // dynamic library load
+        #if defined(PLATFORM_WINDOWS)
+          #ifdef PLATFORM_64BIT
+            lib = load_dynamic({"./openvr_api64.dll", "openvr_api64.dll", "./openvr_api.dll", "openvr_api.dll"});
           #else
-            lib = load_dynamic({"./libopenvr_api.so.dbg", "libopenvr_api.so.dbg", "./libopenvr_api.so", "libopenvr_api.so"});
-          #endif // NDEBUG
-        #else
-          #ifdef NDEBUG
-            lib = load_dynamic({"./libopenvr_api32.so", "libopenvr_api32.so", "./libopenvr_api.so", "libopenvr_api.so"});
+            lib = load_dynamic({"./openvr_api.dll", "openvr_api.dll"});
+          #endif // PLATFORM_64BIT
+        #elif defined(PLATFORM_LINUX)
+          #ifdef PLATFORM_64BIT
+            #ifdef NDEBUG
+              lib = load_dynamic({"./libopenvr_api.so", "libopenvr_api.so"});
+            #else
+              lib = load_dynamic({"./libopenvr_api.so.dbg", "libopenvr_api.so.dbg", "./libopenvr_api.so", "libopenvr_api.so"});
+            #endif // NDEBUG
           #else
-            lib = load_dynamic({"./libopenvr_api32.so.dbg", "libopenvr_api32.so.dbg", "./libopenvr_api32.so", "libopenvr_api32.so", "./libopenvr_api.so.dbg", "libopenvr_api.so.dbg", "./libopenvr_api.so", "libopenvr_api.so"});
-          #endif // NDEBUG
-        #endif // PLATFORM_64BIT
-      #elif defined(PLATFORM_MACOS)
-        lib = load_dynamic({"./libopenvr_api.dylib", "libopenvr_api.dylib"});
-      #else
-        #error "platform_defines.h must be included!"
-      #endif
-      if(!lib) {
-        std::cout << "VRStorm: No OpenVR dynamic library found, not initialising." << std::endl;
-        shutdown();
-        return;
+            #ifdef NDEBUG
+              lib = load_dynamic({"./libopenvr_api32.so", "libopenvr_api32.so", "./libopenvr_api.so", "libopenvr_api.so"});
+            #else
+              lib = load_dynamic({"./libopenvr_api32.so.dbg", "libopenvr_api32.so.dbg", "./libopenvr_api32.so", "libopenvr_api32.so", "./libopenvr_api.so.dbg", "libopenvr_api.so.dbg", "./libopenvr_api.so", "libopenvr_api.so"});
+            #endif // NDEBUG
+          #endif // PLATFORM_64BIT
+        #elif defined(PLATFORM_MACOS)
+          lib = load_dynamic({"./libopenvr_api.dylib", "libopenvr_api.dylib"});
+        #else
+          #error "platform_defines.h must be included!"
+        #endif
+        if(!lib) {
+          log(logger::level::info) << "VRStorm: No OpenVR dynamic library found, not initialising.";
+          shutdown();
+          return;
+        }
+
+        symbols.load(lib);                                                      // resolve everything once, rather than on each use
       }
+      end_phase("library");
 
-      //bool (*VR_IsRuntimeInstalled)() = (bool(*)())dlsym(lib, "VR_IsRuntimeInstalled");
-      //bool (*VR_IsRuntimeInstalled)() = (decltype(&vr::VR_IsRuntimeInstalled))dlsym(lib, "VR_IsRuntimeInstalled");
-      //auto VR_IsRuntimeInstalled = reinterpret_cast<decltype(&vr::VR_IsRuntimeInstalled)>(dlsym(lib, "VR_IsRuntimeInstalled"));
-      auto VR_IsRuntimeInstalled                 = load_symbol<decltype(&vr::VR_IsRuntimeInstalled                )>(lib, "VR_IsRuntimeInstalled");
       // preliminary checks
-      if(!VR_IsRuntimeInstalled()) {
-        std::cout << "VRStorm: No VR runtime installed." << std::endl;
+      if(!symbols.VR_IsRuntimeInstalled()) {
+        log(logger::level::info) << "VRStorm: No VR runtime installed.";
         shutdown();
         return;
       }
-      auto VR_RuntimePath                        = load_symbol<decltype(&vr::VR_RuntimePath                       )>(lib, "VR_RuntimePath");
-      auto VR_IsHmdPresent                       = load_symbol<decltype(&vr::VR_IsHmdPresent                      )>(lib, "VR_IsHmdPresent");
-      std::cout << "VRStorm: VR runtime installed in " << VR_RuntimePath() << std::endl;
-      if(!VR_IsHmdPresent()) {
-        std::cout << "VRStorm: No head mounted display present." << std::endl;
+      log(logger::level::info) << "VRStorm: VR runtime installed in " << symbols.VR_RuntimePath();
+      if(!symbols.VR_IsHmdPresent()) {
+        log(logger::level::info) << "VRStorm: No head mounted display present.";
         shutdown();
         return;
       }
-      std::cout << "VRStorm: Head mounted display may be present, initialising..." << std::endl;
-      #ifdef DEBUG_VRSTORM
-        std::cout << "VRStorm: DEBUG: Loading symbols..." << std::endl;
-      #endif // DEBUG_VRSTORM
-      auto VR_InitInternal                       = load_symbol<decltype(&vr::VR_InitInternal                      )>(lib, "VR_InitInternal");
-      auto VR_IsInterfaceVersionValid            = load_symbol<decltype(&vr::VR_IsInterfaceVersionValid           )>(lib, "VR_IsInterfaceVersionValid");
-      auto VR_GetVRInitErrorAsEnglishDescription = load_symbol<decltype(&vr::VR_GetVRInitErrorAsEnglishDescription)>(lib, "VR_GetVRInitErrorAsEnglishDescription");
-      auto VR_GetGenericInterface                = load_symbol<decltype(&vr::VR_GetGenericInterface               )>(lib, "VR_GetGenericInterface");
-      auto VR_GetInitToken                       = load_symbol<decltype(&vr::VR_GetInitToken                      )>(lib, "VR_GetInitToken");
-      #ifdef DEBUG_VRSTORM
-        std::cout << "VRStorm: DEBUG: Symbols loaded successfully." << std::endl;
-      #endif // DEBUG_VRSTORM
+      log(logger::level::info) << "VRStorm: Head mounted display may be present, initialising...";
 
       // initialise the vr system
       vr::EVRInitError vr_error = vr::VRInitError_None;
 
       // the following is a replacement for hmd_handle = vr::VR_Init(&vr_error, vr::VRApplication_Scene);
-      vr::VRToken() = VR_InitInternal(&vr_error, vr::VRApplication_Scene);
+      vr::VRToken() = symbols.VR_InitInternal(&vr_error, vr::VRApplication_Scene);
       vr::COpenVRContext &vr_ctx = vr::OpenVRInternal_ModuleContext();
       vr_ctx.Clear();
       if(vr_error != vr::VRInitError_None) {
-        std::cout << "VRStorm: Unable to init VR runtime: " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl;
-        //std::cout << "VRStorm: VR init error: " << VR_GetVRInitErrorAsSymbol(vr_error) << std::endl;
+        log(logger::level::error) << "VRStorm: Unable to init VR runtime: " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error);
+        //log(logger::level::info) << "VRStorm: VR init error: " << VR_GetVRInitErrorAsSymbol(vr_error);
         return;
       }
-      #ifdef DEBUG_VRSTORM
-        std::cout << "VRStorm: DEBUG: Context cleared." << std::endl;
-      #endif // DEBUG_VRSTORM
-      if(!VR_IsInterfaceVersionValid(vr::IVRSystem_Version)) {
+      log(logger::level::debug) << "VRStorm: DEBUG: Context cleared.";
+      if(!symbols.VR_IsInterfaceVersionValid(vr::IVRSystem_Version)) {
         vr_error = vr::VRInitError_Init_InterfaceNotFound;
-        std::cout << "VRStorm: Unable to init VR runtime, interface not found: " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl;
+        log(logger::level::error) << "VRStorm: Unable to init VR runtime, interface not found: " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error);
         shutdown();
         return;
       }
-      #ifdef DEBUG_VRSTORM
-        std::cout << "VRStorm: DEBUG: Interface version is valid." << std::endl;
-      #endif // DEBUG_VRSTORM
+      log(logger::level::debug) << "VRStorm: DEBUG: Interface version is valid.";
       // the following replaces CheckClear();
-      if(vr::VRToken() != VR_GetInitToken()) {
+      if(vr::VRToken() != symbols.VR_GetInitToken()) {
         vr_ctx.Clear();
-        vr::VRToken() = VR_GetInitToken();
+        vr::VRToken() = symbols.VR_GetInitToken();
       }
       // the following replaces hmd_handle = vr::VRSystem();
-      hmd_handle = static_cast<vr::IVRSystem*>(VR_GetGenericInterface(vr::IVRSystem_Version, &vr_error));
+      hmd_handle = static_cast<vr::IVRSystem*>(symbols.VR_GetGenericInterface(vr::IVRSystem_Version, &vr_error));
       if(!hmd_handle) {
-        std::cout << "VRStorm: Unable to init VR runtime, although no error was returned!" << std::endl;
+        log(logger::level::error) << "VRStorm: Unable to init VR runtime, although no error was returned!";
         shutdown();
         return;
       }
-      #ifdef DEBUG_VRSTORM
-        std::cout << "VRStorm: DEBUG: HMD handle obtained." << std::endl;
-      #endif // DEBUG_VRSTORM
-      std::string vr_driver  = get_tracked_device_string(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_TrackingSystemName_String);
-      std::string vr_display = get_tracked_device_string(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String);
-      std::cout << "VRStorm: Initialised, driver: " << vr_driver << ", display: " << vr_display << std::endl;
+      log(logger::level::debug) << "VRStorm: DEBUG: HMD handle obtained.";
+      end_phase("runtime");
 
       {
         vec2<uint32_t> this_render_target_size;
         hmd_handle->GetRecommendedRenderTargetSize(&this_render_target_size.x, &this_render_target_size.y);
         render_target_size = this_render_target_size;
+        scaled_render_target_size = render_target_size;
+        resolution.reset();
       }
-      std::cout << "VRStorm: Render target size: " << render_target_size << std::endl;
 
       // initialise the compositor, the following replaces compositor = vr::VRCompositor();
-      compositor = static_cast<vr::IVRCompositor*>(VR_GetGenericInterface(vr::IVRCompositor_Version, &vr_error));
+      compositor = static_cast<vr::IVRCompositor*>(symbols.VR_GetGenericInterface(vr::IVRCompositor_Version, &vr_error));
       if(!compositor) {
-        std::cout << "VRStorm: Unable to initialise VR compositor: " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl;
+        log(logger::level::error) << "VRStorm: Unable to initialise VR compositor: " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error);
         shutdown();
         return;
       }
+      frame_duration = 1.0f / hmd_handle->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+      vsync_to_photon_time = hmd_handle->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float);
+      tracking_space = compositor->GetTrackingSpace();                          // cached for predicted pose requests
+      end_phase("compositor");
+
+      // identify tracked devices - only what the first frame needs, everything else is cached when first used
+      for(unsigned int i = 0; i != vr::k_unMaxTrackedDeviceCount; ++i) {
+        if(!hmd_handle->IsTrackedDeviceConnected(i)) {
+          continue;
+        }
+        vr::ETrackedDeviceClass const device_class = hmd_handle->GetTrackedDeviceClass(i);
+        if(i == vr::k_unTrackedDeviceIndex_Hmd || get_device_list(device_class)) {
+          refresh_device_properties(i);                                         // cache everything we'll need about this device
+        }
+        add_tracked_device(i, device_class);                                    // later arrivals are added by the activation event
+      }
+      end_phase("devices");
+
+      input_controller.init();                                                  // assigns and names the hands from the registered devices
+      end_phase("input");
+
+      // get render models if available, the following replaces vr::IVRRenderModels *render_models = vr::VRRenderModels();
+      vr::IVRRenderModels *render_models = static_cast<vr::IVRRenderModels*>(symbols.VR_GetGenericInterface(vr::IVRRenderModels_Version, &vr_error));
+      if(render_models) {
+        model_cache.init(render_model_cache_path);
+        model_loader.init(render_models);
+        for(auto const &it : controllers) {                                     // request models for controllers and trackers, they arrive during later updates
+          load_controller_model(it.id);
+        }
+        for(auto const &it : trackers) {
+          load_controller_model(it.id);
+        }
+        // this works, but no need to implement it yet:
+        /*
+        for(unsigned int i = 0; i != render_models->GetRenderModelCount(); ++i) {
+          size_t buffer_len = render_models->GetRenderModelName(i, nullptr, 0);
+          std::string buffer(buffer_len, '\0');
+          render_models->GetRenderModelName(i, &buffer[0], cast_if_required<uint32_t>(buffer.size()));
+          log(logger::level::info) << "VRStorm: Render model " << i << ": \"" << buffer << "\"";
+        }
+        */
+      } else {
+        log(logger::level::warning) << "VRStorm: Unable to get render model interface: " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error); // this is not a fatal error - we just carry on
+      }
+      end_phase("render models");
+
+      update_ipd(get_device_properties(vr::k_unTrackedDeviceIndex_Hmd).user_ipd); // set up the initial eye transforms
+      hidden_area.update(hmd_handle);
+
+      // grab the initial poses
+      enabled = true;
+      update();
+      {
+        vec3f const head_position(hmd_position.get_translation());
+        if(head_position.y == 0.0f) {
+          log(logger::level::info) << "VRStorm: HMD initial position is invalid, defaulting to " << head_height << "m starting head height";
+        } else {
+          head_height = -head_position.y;
+          log(logger::level::info) << "VRStorm: Starting head height is " << head_height << "m";
+        }
+      }
+      end_phase("initial poses");
+
+      diagnostics_pending = true;                                               // log everything else on the next update, so it doesn't hold up the first frame
+
+      auto line(log(logger::level::info));
+      line << "VRStorm: Successfully initialised in " << std::chrono::duration<float, std::milli>(time_phase - time_start).count() << "ms:";
+      for(auto const &it : init_timings) {
+        line << " " << it.name << " " << it.milliseconds << "ms";
+      }
+    } catch(std::exception &e) {
+      log(logger::level::error) << "VRStorm: Exception at startup: " << e.what();
+      shutdown();
+    }
+  #else
+    log(logger::level::info) << "VRStorm: VR is disabled in this build.";
+  #endif // VRSTORM_DISABLED
+}
+
+#ifndef VRSTORM_DISABLED
+  void manager::log_diagnostics() {
+    /// Log details of the runtime, chaperone and devices that rendering doesn't depend on - called once by update_events()
+    // NOTE: the runtime is only queried from the thread that updates; the logger's writer thread does the output
+    try {
+      vr::EVRInitError vr_error = vr::VRInitError_None;
+      std::string vr_driver  = get_tracked_device_string(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_TrackingSystemName_String);
+      std::string vr_display = get_tracked_device_string(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String);
+      log(logger::level::info) << "VRStorm: Initialised, driver: " << vr_driver << ", display: " << vr_display;
+      log(logger::level::info) << "VRStorm: Render target size: " << render_target_size;
       /*
       if(compositor->GetVSync()) {
-        std::cout << "VRStorm: Compositor vsync enabled" << std::endl;
+        log(logger::level::info) << "VRStorm: Compositor vsync enabled";
       } else {
-        std::cout << "VRStorm: Compositor vsync disabled" << std::endl;
+        log(logger::level::info) << "VRStorm: Compositor vsync disabled";
       }
       */
       if(compositor->IsFullscreen()) {
-        std::cout << "VRStorm: Compositor is fullscreen" << std::endl;
+        log(logger::level::info) << "VRStorm: Compositor is fullscreen";
       } else {
-        std::cout << "VRStorm: Compositor is not fullscreen" << std::endl;
-      }
-      //std::cout << "VRStorm: Compositor gamma: " << compositor->GetGamma() << std::endl;
-      float const display_freq = hmd_handle->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
-      float const frame_duration = 1.0f / display_freq;
-      std::cout << "VRStorm: Display frequency: " << display_freq << "Hz, frame duration " << frame_duration << "s" << std::endl;
-      float const vsync_to_photon_time = hmd_handle->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float);
-      std::cout << "VRStorm: Time from vsync to photons: " << vsync_to_photon_time << "s" << std::endl;
-      // in the loop, predicted pose time for GetDeviceToAbsoluteTrackingPose as per https://github.com/ValveSoftware/openvr/wiki/IVRSystem::GetDeviceToAbsoluteTrackingPose:
-      //   float time_since_vsync;
-      //   hmd_handle->GetTimeSinceLastVsync(&time_since_vsync, nullptr);
-      //   float time_to_photons = frame_duration - time_since_vsync + vsync_to_photon_time;
-      switch(compositor->GetTrackingSpace()) {
+        log(logger::level::info) << "VRStorm: Compositor is not fullscreen";
+      }
+      //log(logger::level::info) << "VRStorm: Compositor gamma: " << compositor->GetGamma();
+      log(logger::level::info) << "VRStorm: Display frequency: " << 1.0f / frame_duration << "Hz, frame duration " << frame_duration << "s";
+      log(logger::level::info) << "VRStorm: Time from vsync to photons: " << vsync_to_photon_time << "s";
+      switch(tracking_space) {
       case vr::TrackingUniverseSeated:                                          // Poses are provided relative to the seated zero pose
-        std::cout << "VRStorm: Tracking relative to seated position." << std::endl;
+        log(logger::level::info) << "VRStorm: Tracking relative to seated position.";
         break;
       case vr::TrackingUniverseStanding:                                        // Poses are provided relative to the safe bounds configured by the user
-        std::cout << "VRStorm: Tracking relative to standing space." << std::endl;
+        log(logger::level::info) << "VRStorm: Tracking relative to standing space.";
         break;
       case vr::TrackingUniverseRawAndUncalibrated:                              // Poses are provided in the coordinate system defined by the driver. You probably don't want this one.
-        std::cout << "VRStorm: Tracking relative to raw uncalibrated coordinates." << std::endl;
+        log(logger::level::info) << "VRStorm: Tracking relative to raw uncalibrated coordinates.";
         break;
       default:
-        std::cout << "VRStorm: Tracking relative to unknown space: " << compositor->GetTrackingSpace() << std::endl;
+        log(logger::level::info) << "VRStorm: Tracking relative to unknown space: " << tracking_space;
         break;
       }
 
       // initialise the chaperone, the following replaces vr::IVRChaperone *chaperone = vr::VRChaperone();
-      vr::IVRChaperone *chaperone = static_cast<vr::IVRChaperone*>(VR_GetGenericInterface(vr::IVRChaperone_Version, &vr_error));
+      vr::IVRChaperone *chaperone = static_cast<vr::IVRChaperone*>(symbols.VR_GetGenericInterface(vr::IVRChaperone_Version, &vr_error));
       if(chaperone) {
         // we've just requested startup, so base stations may not be tracking yet - this is normal
         switch(chaperone->GetCalibrationState()) {
         case vr::ChaperoneCalibrationState_OK:
-          std::cout << "VRStorm: Chaperone is fully calibrated and working correctly" << std::endl;
+          log(logger::level::info) << "VRStorm: Chaperone is fully calibrated and working correctly";
           break;
         case vr::ChaperoneCalibrationState_Warning:
           break;
         case vr::ChaperoneCalibrationState_Warning_BaseStationMayHaveMoved:
-          std::cout << "VRStorm: Chaperone WARNING: A base station thinks that it might have moved." << std::endl;
+          log(logger::level::warning) << "VRStorm: Chaperone WARNING: A base station thinks that it might have moved.";
           break;
         case vr::ChaperoneCalibrationState_Warning_BaseStationRemoved:
-          std::cout << "VRStorm: Chaperone WARNING: There are fewer base stations than when calibrated." << std::endl;
+          log(logger::level::warning) << "VRStorm: Chaperone WARNING: There are fewer base stations than when calibrated.";
           break;
         case vr::ChaperoneCalibrationState_Warning_SeatedBoundsInvalid:
-          std::cout << "VRStorm: Chaperone WARNING: Seated bounds haven't been calibrated for the current tracking centre." << std::endl;
+          log(logger::level::warning) << "VRStorm: Chaperone WARNING: Seated bounds haven't been calibrated for the current tracking centre.";
           break;
         case vr::ChaperoneCalibrationState_Error:
-          std::cout << "VRStorm: Chaperone ERROR: The UniverseID is invalid." << std::endl;
+          log(logger::level::error) << "VRStorm: Chaperone ERROR: The UniverseID is invalid.";
           break;
         case vr::ChaperoneCalibrationState_Error_BaseStationUninitalized:
-          std::cout << "VRStorm: Chaperone ERROR: Tracking centre hasn't been calibrated for at least one of the base stations" << std::endl;
+          log(logger::level::error) << "VRStorm: Chaperone ERROR: Tracking centre hasn't been calibrated for at least one of the base stations";
           break;
         case vr::ChaperoneCalibrationState_Error_BaseStationConflict:
-          std::cout << "VRStorm: Chaperone ERROR: Tracking centre is calibrated, but base stations disagree on the tracking space." << std::endl;
+          log(logger::level::error) << "VRStorm: Chaperone ERROR: Tracking centre is calibrated, but base stations disagree on the tracking space.";
           break;
         case vr::ChaperoneCalibrationState_Error_PlayAreaInvalid:
-          std::cout << "VRStorm: Chaperone ERROR: Play area hasn't been calibrated for the current tracking centre." << std::endl;
+          log(logger::level::error) << "VRStorm: Chaperone ERROR: Play area hasn't been calibrated for the current tracking centre.";
           break;
         case vr::ChaperoneCalibrationState_Error_CollisionBoundsInvalid:
-          std::cout << "VRStorm: Chaperone ERROR: Collision bounds haven't been calibrated for the current tracking centre." << std::endl;
+          log(logger::level::error) << "VRStorm: Chaperone ERROR: Collision bounds haven't been calibrated for the current tracking centre.";
           break;
         default:
-          std::cout << "VRStorm: Unknown chaperone calibration state " << chaperone->GetCalibrationState() << std::endl;
+          log(logger::level::warning) << "VRStorm: Unknown chaperone calibration state " << chaperone->GetCalibrationState();
           break;
         }
         vec2f play_area_size;
         if(chaperone->GetPlayAreaSize(&play_area_size.x, &play_area_size.y)) {
-          std::cout << "VRStorm: Play area size: " << render_target_size << std::endl;
+          log(logger::level::info) << "VRStorm: Play area size: " << play_area_size;
         } else {
-          std::cout << "VRStorm: Could not get play area size";                 // this is not an error in the case of seating or standing configurations
+          auto line(log(logger::level::info));
+          line << "VRStorm: Could not get play area size";                      // this is not an error in the case of seating or standing configurations
           if(vr_error == 0) {
-            std::cout << "." << std::endl;
+            line << ".";
           } else {
-            std::cout << ": " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl;
+            line << ": " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error);
           }
         }
         std::array<vec3f, 4> play_area_rect;
@@ -235,18 +338,19 @@ void manager::init() {
                                             play_area_quad.vCorners[corner].v[1],
                                             play_area_quad.vCorners[corner].v[2]);
             }
-            std::cout << "VRStorm: Play area rectangle: " << play_area_rect[0] << ", " << play_area_rect[1] << ", " << play_area_rect[2] << ", " << play_area_rect[3] << std::endl;
+            log(logger::level::info) << "VRStorm: Play area rectangle: " << play_area_rect[0] << ", " << play_area_rect[1] << ", " << play_area_rect[2] << ", " << play_area_rect[3];
           } else {
-            std::cout << "VRStorm: Could not get play area rectangle";          // this is not an error in the case of seating or standing configurations
+            auto line(log(logger::level::info));
+            line << "VRStorm: Could not get play area rectangle";               // this is not an error in the case of seating or standing configurations
             if(vr_error == 0) {
-              std::cout << "." << std::endl;
+              line << ".";
             } else {
-              std::cout << ": " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl;
+              line << ": " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error);
             }
           }
         }
       } else {
-        std::cout << "VRStorm: Unable to initialise chaperone: " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl;
+        log(logger::level::warning) << "VRStorm: Unable to initialise chaperone: " << symbols.VR_GetVRInitErrorAsEnglishDescription(vr_error);
         //shutdown();
         //return;
       }
@@ -257,287 +361,235 @@ void manager::init() {
         if(!hmd_handle->IsTrackedDeviceConnected(i)) {
           continue;
         }
-        if(i == vr::k_unTrackedDeviceIndex_Hmd) {
-          std::cout << "VRStorm: Primary HMD(" << i << "): ";
-        } else {
-          std::cout << "VRStorm: Device " << i << ": ";
-        }
-        switch(hmd_handle->GetTrackedDeviceClass(i)) {
-        case vr::TrackedDeviceClass_Invalid:
-          std::cout << "Invalid device:" << std::endl;
-          break;
-        case vr::TrackedDeviceClass_HMD:                                        // Head-Mounted Displays
-          if(i != vr::k_unTrackedDeviceIndex_Hmd) {
-            std::cout << "HMD: ";
+        {
+          auto line(log(logger::level::info));
+          if(i == vr::k_unTrackedDeviceIndex_Hmd) {
+            line << "VRStorm: Primary HMD(" << i << "): ";
+          } else {
+            line << "VRStorm: Device " << i << ": ";
+          }
+          switch(hmd_handle->GetTrackedDeviceClass(i)) {
+          case vr::TrackedDeviceClass_Invalid:
+            line << "Invalid device:";
+            break;
+          case vr::TrackedDeviceClass_HMD:                                      // Head-Mounted Displays
+            if(i != vr::k_unTrackedDeviceIndex_Hmd) {
+              line << "HMD: ";
+            }
+            break;
+          case vr::TrackedDeviceClass_Controller:                               // Tracked controllers
+            line << "Controller: ";
+            controller_ids.emplace_back(i);
+            break;
+          case vr::TrackedDeviceClass_TrackingReference:                        // Camera and base stations that serve as tracking reference points
+            line << "Tracking reference: ";
+            break;
+          case vr::TrackedDeviceClass_Other:
+            line << "Unknown device: ";
+            break;
+          default:
+            line << "Unrecognised (class " << hmd_handle->GetTrackedDeviceClass(i) << ") device: ";
+            break;
+          }
+          //line << get_tracked_device_string(i, vr::Prop_ManufacturerName_String) << " " << get_tracked_device_string(i, vr::Prop_ModelNumber_String) << " " << get_tracked_device_string(i, vr::Prop_HardwareRevision_String);
+          line << get_tracked_device_string(i, vr::Prop_ManufacturerName_String) << " " << get_tracked_device_string(i, vr::Prop_ModelNumber_String) << " tracked by " << get_tracked_device_string(i, vr::Prop_TrackingSystemName_String);
+          switch(hmd_handle->GetTrackedDeviceActivityLevel(i)) {
+          case vr::k_EDeviceActivityLevel_Unknown:
+            line << ", status unknown";
+            break;
+          case vr::k_EDeviceActivityLevel_Idle:
+            line << ", idle";
+            break;
+          case vr::k_EDeviceActivityLevel_UserInteraction:
+            line << ", interactive";
+            break;
+          case vr::k_EDeviceActivityLevel_UserInteraction_Timeout:
+            line << ", timeout";
+            break;
+          case vr::k_EDeviceActivityLevel_Standby:
+            line << ", standby";
+            break;
+          default:
+            line << ", status unrecognised";
+            break;
           }
-          break;
-        case vr::TrackedDeviceClass_Controller:                                 // Tracked controllers
-          std::cout << "Controller: ";
-          controller_ids.emplace_back(i);
-          break;
-        case vr::TrackedDeviceClass_TrackingReference:                          // Camera and base stations that serve as tracking reference points
-          std::cout << "Tracking reference: ";
-          break;
-        case vr::TrackedDeviceClass_Other:
-          std::cout << "Unknown device: " << std::endl;
-          break;
-        default:
-          std::cout << "Unrecognised (class " << hmd_handle->GetTrackedDeviceClass(i) << ") device: " << std::endl;
-          break;
-        }
-        //std::cout << get_tracked_device_string(i, vr::Prop_ManufacturerName_String) << " " << get_tracked_device_string(i, vr::Prop_ModelNumber_String) << " " << get_tracked_device_string(i, vr::Prop_HardwareRevision_String);
-        std::cout << get_tracked_device_string(i, vr::Prop_ManufacturerName_String) << " " << get_tracked_device_string(i, vr::Prop_ModelNumber_String) << " tracked by " << get_tracked_device_string(i, vr::Prop_TrackingSystemName_String);
-        switch(hmd_handle->GetTrackedDeviceActivityLevel(i)) {
-        case vr::k_EDeviceActivityLevel_Unknown:
-          std::cout << ", status unknown";
-          break;
-        case vr::k_EDeviceActivityLevel_Idle:
-          std::cout << ", idle";
-          break;
-        case vr::k_EDeviceActivityLevel_UserInteraction:
-          std::cout << ", interactive";
-          break;
-        case vr::k_EDeviceActivityLevel_UserInteraction_Timeout:
-          std::cout << ", timeout";
-          break;
-        case vr::k_EDeviceActivityLevel_Standby:
-          std::cout << ", standby";
-          break;
-        default:
-          std::cout << ", status unrecognised";
-          break;
         }
-        std::cout << std::endl;
-        #ifdef DEBUG_VRSTORM
-          std::cout << std::boolalpha;
-          std::cout << "VRStorm: DEBUG: TrackingSystemName_String            " << get_tracked_device_string(                   i, vr::Prop_TrackingSystemName_String           ) << std::endl; // lighthouse
-          std::cout << "VRStorm: DEBUG: ModelNumber_String                   " << get_tracked_device_string(                   i, vr::Prop_ModelNumber_String                  ) << std::endl; // Vive MV
-          std::cout << "VRStorm: DEBUG: SerialNumber_String                  " << get_tracked_device_string(                   i, vr::Prop_SerialNumber_String                 ) << std::endl; // LHR-F3A6281E
-          std::cout << "VRStorm: DEBUG: RenderModelName_String               " << get_tracked_device_string(                   i, vr::Prop_RenderModelName_String              ) << std::endl; // generic_hmd | lh_basestation_vive
-          std::cout << "VRStorm: DEBUG: WillDriftInYaw_Bool                  " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_WillDriftInYaw_Bool                 ) << std::endl; // 0
-          std::cout << "VRStorm: DEBUG: ManufacturerName_String              " << get_tracked_device_string(                   i, vr::Prop_ManufacturerName_String             ) << std::endl; // HTC
-          std::cout << "VRStorm: DEBUG: TrackingFirmwareVersion_String       " << get_tracked_device_string(                   i, vr::Prop_TrackingFirmwareVersion_String      ) << std::endl; // 1462663157 steamservices@firmware-win32 2016-05-08 FPGA 1.6
-          std::cout << "VRStorm: DEBUG: HardwareRevision_String              " << get_tracked_device_string(                   i, vr::Prop_HardwareRevision_String             ) << std::endl; // product 128 rev 2.1.0 lot 2000/0/0 0
-          std::cout << "VRStorm: DEBUG: AllWirelessDongleDescriptions_String " << get_tracked_device_string(                   i, vr::Prop_AllWirelessDongleDescriptions_String) << std::endl; // 3580A4F484=1461100729;ADCC7BC54A=1461100729
-          std::cout << "VRStorm: DEBUG: ConnectedWirelessDongle_String       " << get_tracked_device_string(                   i, vr::Prop_ConnectedWirelessDongle_String      ) << std::endl; // ""
-          std::cout << "VRStorm: DEBUG: DeviceIsWireless_Bool                " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceIsWireless_Bool               ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: DeviceIsCharging_Bool                " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceIsCharging_Bool               ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: DeviceBatteryPercentage_Float        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DeviceBatteryPercentage_Float       ) << std::endl; // 0
-          //std::cout << "VRStorm: DEBUG: StatusDisplayTransform_Matrix34      " << hmd_handle->GetMatrix34TrackedDeviceProperty(i, vr::Prop_StatusDisplayTransform_Matrix34     ) << std::endl;
-          std::cout << "VRStorm: DEBUG: Firmware_UpdateAvailable_Bool        " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_Firmware_UpdateAvailable_Bool       ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: Firmware_ManualUpdate_Bool           " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_Firmware_ManualUpdate_Bool          ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: Firmware_ManualUpdateURL_String      " << get_tracked_device_string(                   i, vr::Prop_Firmware_ManualUpdateURL_String     ) << std::endl; // https://developer.valvesoftware.com/wiki/SteamVR/HowTo_Update_Firmware
-          std::cout << "VRStorm: DEBUG: HardwareRevision_Uint64              " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_HardwareRevision_Uint64             ) << std::endl; // 2164327680
-          std::cout << "VRStorm: DEBUG: FirmwareVersion_Uint64               " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_FirmwareVersion_Uint64              ) << std::endl; // 1462663157
-          std::cout << "VRStorm: DEBUG: FPGAVersion_Uint64                   " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_FPGAVersion_Uint64                  ) << std::endl; // 262
-          std::cout << "VRStorm: DEBUG: VRCVersion_Uint64                    " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_VRCVersion_Uint64                   ) << std::endl; // 1465809477
-          std::cout << "VRStorm: DEBUG: RadioVersion_Uint64                  " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_RadioVersion_Uint64                 ) << std::endl; // 1466630404
-          std::cout << "VRStorm: DEBUG: DongleVersion_Uint64                 " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DongleVersion_Uint64                ) << std::endl; // 1461100729
-          std::cout << "VRStorm: DEBUG: BlockServerShutdown_Bool             " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_BlockServerShutdown_Bool            ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: CanUnifyCoordinateSystemWithHmd_Bool " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_CanUnifyCoordinateSystemWithHmd_Bool) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: ContainsProximitySensor_Bool         " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_ContainsProximitySensor_Bool        ) << std::endl; // true
-          std::cout << "VRStorm: DEBUG: DeviceProvidesBatteryStatus_Bool     " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceProvidesBatteryStatus_Bool    ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: DeviceCanPowerOff_Bool               " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceCanPowerOff_Bool              ) << std::endl; // false
-          std::cout << "VRStorm: DEBUG: Firmware_ProgrammingTarget_String    " << get_tracked_device_string(                   i, vr::Prop_Firmware_ProgrammingTarget_String   ) << std::endl; // LHR-F3A6281E
-          std::cout << "VRStorm: DEBUG: DeviceClass_Int32                    " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_DeviceClass_Int32                   ) << std::endl; // 1
-          std::cout << "VRStorm: DEBUG: HasCamera_Bool                       " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_HasCamera_Bool                      ) << std::endl; // true
-          std::cout << "VRStorm: DEBUG: DriverVersion_String                 " << get_tracked_device_string(                   i, vr::Prop_DriverVersion_String                ) << std::endl; // ""
-          std::cout << "VRStorm: DEBUG: Firmware_ForceUpdateRequired_Bool    " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_Firmware_ForceUpdateRequired_Bool   ) << std::endl; // false
+        if(log.enabled(logger::level::debug)) {                                 // full property dump, only worth querying when it'll be seen
+          log(logger::level::debug) << "VRStorm: DEBUG: TrackingSystemName_String            " << get_tracked_device_string(                   i, vr::Prop_TrackingSystemName_String           ); // lighthouse
+          log(logger::level::debug) << "VRStorm: DEBUG: ModelNumber_String                   " << get_tracked_device_string(                   i, vr::Prop_ModelNumber_String                  ); // Vive MV
+          log(logger::level::debug) << "VRStorm: DEBUG: SerialNumber_String                  " << get_tracked_device_string(                   i, vr::Prop_SerialNumber_String                 ); // LHR-F3A6281E
+          log(logger::level::debug) << "VRStorm: DEBUG: RenderModelName_String               " << get_tracked_device_string(                   i, vr::Prop_RenderModelName_String              ); // generic_hmd | lh_basestation_vive
+          log(logger::level::debug) << "VRStorm: DEBUG: WillDriftInYaw_Bool                  " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_WillDriftInYaw_Bool                 ); // 0
+          log(logger::level::debug) << "VRStorm: DEBUG: ManufacturerName_String              " << get_tracked_device_string(                   i, vr::Prop_ManufacturerName_String             ); // HTC
+          log(logger::level::debug) << "VRStorm: DEBUG: TrackingFirmwareVersion_String       " << get_tracked_device_string(                   i, vr::Prop_TrackingFirmwareVersion_String      ); // 1462663157 steamservices@firmware-win32 2016-05-08 FPGA 1.6
+          log(logger::level::debug) << "VRStorm: DEBUG: HardwareRevision_String              " << get_tracked_device_string(                   i, vr::Prop_HardwareRevision_String             ); // product 128 rev 2.1.0 lot 2000/0/0 0
+          log(logger::level::debug) << "VRStorm: DEBUG: AllWirelessDongleDescriptions_String " << get_tracked_device_string(                   i, vr::Prop_AllWirelessDongleDescriptions_String); // 3580A4F484=1461100729;ADCC7BC54A=1461100729
+          log(logger::level::debug) << "VRStorm: DEBUG: ConnectedWirelessDongle_String       " << get_tracked_device_string(                   i, vr::Prop_ConnectedWirelessDongle_String      ); // ""
+          log(logger::level::debug) << "VRStorm: DEBUG: DeviceIsWireless_Bool                " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceIsWireless_Bool               ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: DeviceIsCharging_Bool                " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceIsCharging_Bool               ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: DeviceBatteryPercentage_Float        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DeviceBatteryPercentage_Float       ); // 0
+          //log(logger::level::debug) << "VRStorm: DEBUG: StatusDisplayTransform_Matrix34      " << hmd_handle->GetMatrix34TrackedDeviceProperty(i, vr::Prop_StatusDisplayTransform_Matrix34     );
+          log(logger::level::debug) << "VRStorm: DEBUG: Firmware_UpdateAvailable_Bool        " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_Firmware_UpdateAvailable_Bool       ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: Firmware_ManualUpdate_Bool           " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_Firmware_ManualUpdate_Bool          ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: Firmware_ManualUpdateURL_String      " << get_tracked_device_string(                   i, vr::Prop_Firmware_ManualUpdateURL_String     ); // https://developer.valvesoftware.com/wiki/SteamVR/HowTo_Update_Firmware
+          log(logger::level::debug) << "VRStorm: DEBUG: HardwareRevision_Uint64              " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_HardwareRevision_Uint64             ); // 2164327680
+          log(logger::level::debug) << "VRStorm: DEBUG: FirmwareVersion_Uint64               " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_FirmwareVersion_Uint64              ); // 1462663157
+          log(logger::level::debug) << "VRStorm: DEBUG: FPGAVersion_Uint64                   " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_FPGAVersion_Uint64                  ); // 262
+          log(logger::level::debug) << "VRStorm: DEBUG: VRCVersion_Uint64                    " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_VRCVersion_Uint64                   ); // 1465809477
+          log(logger::level::debug) << "VRStorm: DEBUG: RadioVersion_Uint64                  " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_RadioVersion_Uint64                 ); // 1466630404
+          log(logger::level::debug) << "VRStorm: DEBUG: DongleVersion_Uint64                 " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DongleVersion_Uint64                ); // 1461100729
+          log(logger::level::debug) << "VRStorm: DEBUG: BlockServerShutdown_Bool             " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_BlockServerShutdown_Bool            ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: CanUnifyCoordinateSystemWithHmd_Bool " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_CanUnifyCoordinateSystemWithHmd_Bool); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: ContainsProximitySensor_Bool         " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_ContainsProximitySensor_Bool        ); // true
+          log(logger::level::debug) << "VRStorm: DEBUG: DeviceProvidesBatteryStatus_Bool     " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceProvidesBatteryStatus_Bool    ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: DeviceCanPowerOff_Bool               " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DeviceCanPowerOff_Bool              ); // false
+          log(logger::level::debug) << "VRStorm: DEBUG: Firmware_ProgrammingTarget_String    " << get_tracked_device_string(                   i, vr::Prop_Firmware_ProgrammingTarget_String   ); // LHR-F3A6281E
+          log(logger::level::debug) << "VRStorm: DEBUG: DeviceClass_Int32                    " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_DeviceClass_Int32                   ); // 1
+          log(logger::level::debug) << "VRStorm: DEBUG: HasCamera_Bool                       " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_HasCamera_Bool                      ); // true
+          log(logger::level::debug) << "VRStorm: DEBUG: DriverVersion_String                 " << get_tracked_device_string(                   i, vr::Prop_DriverVersion_String                ); // ""
+          log(logger::level::debug) << "VRStorm: DEBUG: Firmware_ForceUpdateRequired_Bool    " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_Firmware_ForceUpdateRequired_Bool   ); // false
           switch(hmd_handle->GetTrackedDeviceClass(i)) {
           case vr::TrackedDeviceClass_HMD:                                      // Head-Mounted Displays
-            std::cout << "VRStorm: DEBUG: ReportsTimeSinceVSync_Bool                   " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_ReportsTimeSinceVSync_Bool                  ) << std::endl; // true
-            std::cout << "VRStorm: DEBUG: SecondsFromVsyncToPhotons_Float              " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_SecondsFromVsyncToPhotons_Float             ) << std::endl; // 0.0111111
-            std::cout << "VRStorm: DEBUG: DisplayFrequency_Float                       " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayFrequency_Float                      ) << std::endl; // 90
-            std::cout << "VRStorm: DEBUG: UserIpdMeters_Float                          " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_UserIpdMeters_Float                         ) << std::endl; // 0.0647
-            std::cout << "VRStorm: DEBUG: CurrentUniverseId_Uint64                     " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_CurrentUniverseId_Uint64                    ) << std::endl; // 1475689499
-            std::cout << "VRStorm: DEBUG: PreviousUniverseId_Uint64                    " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_PreviousUniverseId_Uint64                   ) << std::endl; // 0
-            std::cout << "VRStorm: DEBUG: DisplayFirmwareVersion_Uint64                " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayFirmwareVersion_Uint64               ) << std::endl; // 2097432
-            std::cout << "VRStorm: DEBUG: IsOnDesktop_Bool                             " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_IsOnDesktop_Bool                            ) << std::endl; // false
-            std::cout << "VRStorm: DEBUG: DisplayMCType_Int32                          " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_DisplayMCType_Int32                         ) << std::endl; // 1
-            std::cout << "VRStorm: DEBUG: DisplayMCOffset_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayMCOffset_Float                       ) << std::endl; // -0.498039
-            std::cout << "VRStorm: DEBUG: DisplayMCScale_Float                         " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayMCScale_Float                        ) << std::endl; // 0.125
-            std::cout << "VRStorm: DEBUG: EdidVendorID_Int32                           " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_EdidVendorID_Int32                          ) << std::endl; // 0
-            std::cout << "VRStorm: DEBUG: DisplayMCImageLeft_String                    " << get_tracked_device_string(                   i, vr::Prop_DisplayMCImageLeft_String                   ) << std::endl; // Green_46GA163P002719_mura_analyzes.mc
-            std::cout << "VRStorm: DEBUG: DisplayMCImageRight_String                   " << get_tracked_device_string(                   i, vr::Prop_DisplayMCImageRight_String                  ) << std::endl; // Green_46HA163W001489_mura_analyzes.mc
-            std::cout << "VRStorm: DEBUG: DisplayGCBlackClamp_Float                    " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCBlackClamp_Float                   ) << std::endl; // 0.0117647
-            std::cout << "VRStorm: DEBUG: EdidProductID_Int32                          " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_EdidProductID_Int32                         ) << std::endl; // 43521
-            //std::cout << "VRStorm: DEBUG: CameraToHeadTransform_Matrix34               " << hmd_handle->GetMatrix34TrackedDeviceProperty(i, vr::Prop_CameraToHeadTransform_Matrix34              ) << std::endl;
-            std::cout << "VRStorm: DEBUG: DisplayGCType_Int32                          " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCType_Int32                         ) << std::endl; // 0
-            std::cout << "VRStorm: DEBUG: DisplayGCOffset_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCOffset_Float                       ) << std::endl; // -0.203125
-            std::cout << "VRStorm: DEBUG: DisplayGCScale_Float                         " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCScale_Float                        ) << std::endl; // 0.166667
-            std::cout << "VRStorm: DEBUG: DisplayGCPrescale_Float                      " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCPrescale_Float                     ) << std::endl; // 0.95
-            std::cout << "VRStorm: DEBUG: DisplayGCImage_String                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCImage_String                       ) << std::endl; // 0
-            std::cout << "VRStorm: DEBUG: LensCenterLeftU_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterLeftU_Float                       ) << std::endl; // 0.545005
-            std::cout << "VRStorm: DEBUG: LensCenterLeftV_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterLeftV_Float                       ) << std::endl; // 0.497215
-            std::cout << "VRStorm: DEBUG: LensCenterRightU_Float                       " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterRightU_Float                      ) << std::endl; // 0.454052
-            std::cout << "VRStorm: DEBUG: LensCenterRightV_Float                       " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterRightV_Float                      ) << std::endl; // 0.497139
-            std::cout << "VRStorm: DEBUG: UserHeadToEyeDepthMeters_Float               " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_UserHeadToEyeDepthMeters_Float              ) << std::endl; // 0.015
-            std::cout << "VRStorm: DEBUG: CameraFirmwareVersion_Uint64                 " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_CameraFirmwareVersion_Uint64                ) << std::endl; // 8590262285
-            std::cout << "VRStorm: DEBUG: CameraFirmwareDescription_String             " << get_tracked_device_string(                   i, vr::Prop_CameraFirmwareDescription_String            ) << std::endl; // Version: 02.05.0D Date: 2016.Feb.26
-            std::cout << "VRStorm: DEBUG: DisplayFPGAVersion_Uint64                    " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayFPGAVersion_Uint64                   ) << std::endl; // 57
-            std::cout << "VRStorm: DEBUG: DisplayBootloaderVersion_Uint64              " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayBootloaderVersion_Uint64             ) << std::endl; // 1048584
-            std::cout << "VRStorm: DEBUG: DisplayHardwareVersion_Uint64                " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayHardwareVersion_Uint64               ) << std::endl; // 19
-            std::cout << "VRStorm: DEBUG: AudioFirmwareVersion_Uint64                  " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_AudioFirmwareVersion_Uint64                 ) << std::endl; // 3
-            std::cout << "VRStorm: DEBUG: CameraCompatibilityMode_Int32                " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_CameraCompatibilityMode_Int32               ) << std::endl; // 0
-            std::cout << "VRStorm: DEBUG: ScreenshotHorizontalFieldOfViewDegrees_Float " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_ScreenshotHorizontalFieldOfViewDegrees_Float) << std::endl; // 85
-            std::cout << "VRStorm: DEBUG: ScreenshotVerticalFieldOfViewDegrees_Float   " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_ScreenshotVerticalFieldOfViewDegrees_Float  ) << std::endl; // 85
-            std::cout << "VRStorm: DEBUG: DisplaySuppressed_Bool                       " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DisplaySuppressed_Bool                      ) << std::endl; // false
+            log(logger::level::debug) << "VRStorm: DEBUG: ReportsTimeSinceVSync_Bool                   " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_ReportsTimeSinceVSync_Bool                  ); // true
+            log(logger::level::debug) << "VRStorm: DEBUG: SecondsFromVsyncToPhotons_Float              " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_SecondsFromVsyncToPhotons_Float             ); // 0.0111111
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayFrequency_Float                       " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayFrequency_Float                      ); // 90
+            log(logger::level::debug) << "VRStorm: DEBUG: UserIpdMeters_Float                          " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_UserIpdMeters_Float                         ); // 0.0647
+            log(logger::level::debug) << "VRStorm: DEBUG: CurrentUniverseId_Uint64                     " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_CurrentUniverseId_Uint64                    ); // 1475689499
+            log(logger::level::debug) << "VRStorm: DEBUG: PreviousUniverseId_Uint64                    " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_PreviousUniverseId_Uint64                   ); // 0
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayFirmwareVersion_Uint64                " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayFirmwareVersion_Uint64               ); // 2097432
+            log(logger::level::debug) << "VRStorm: DEBUG: IsOnDesktop_Bool                             " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_IsOnDesktop_Bool                            ); // false
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayMCType_Int32                          " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_DisplayMCType_Int32                         ); // 1
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayMCOffset_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayMCOffset_Float                       ); // -0.498039
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayMCScale_Float                         " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayMCScale_Float                        ); // 0.125
+            log(logger::level::debug) << "VRStorm: DEBUG: EdidVendorID_Int32                           " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_EdidVendorID_Int32                          ); // 0
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayMCImageLeft_String                    " << get_tracked_device_string(                   i, vr::Prop_DisplayMCImageLeft_String                   ); // Green_46GA163P002719_mura_analyzes.mc
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayMCImageRight_String                   " << get_tracked_device_string(                   i, vr::Prop_DisplayMCImageRight_String                  ); // Green_46HA163W001489_mura_analyzes.mc
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayGCBlackClamp_Float                    " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCBlackClamp_Float                   ); // 0.0117647
+            log(logger::level::debug) << "VRStorm: DEBUG: EdidProductID_Int32                          " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_EdidProductID_Int32                         ); // 43521
+            //log(logger::level::debug) << "VRStorm: DEBUG: CameraToHeadTransform_Matrix34               " << hmd_handle->GetMatrix34TrackedDeviceProperty(i, vr::Prop_CameraToHeadTransform_Matrix34              );
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayGCType_Int32                          " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCType_Int32                         ); // 0
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayGCOffset_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCOffset_Float                       ); // -0.203125
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayGCScale_Float                         " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCScale_Float                        ); // 0.166667
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayGCPrescale_Float                      " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCPrescale_Float                     ); // 0.95
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayGCImage_String                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_DisplayGCImage_String                       ); // 0
+            log(logger::level::debug) << "VRStorm: DEBUG: LensCenterLeftU_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterLeftU_Float                       ); // 0.545005
+            log(logger::level::debug) << "VRStorm: DEBUG: LensCenterLeftV_Float                        " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterLeftV_Float                       ); // 0.497215
+            log(logger::level::debug) << "VRStorm: DEBUG: LensCenterRightU_Float                       " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterRightU_Float                      ); // 0.454052
+            log(logger::level::debug) << "VRStorm: DEBUG: LensCenterRightV_Float                       " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_LensCenterRightV_Float                      ); // 0.497139
+            log(logger::level::debug) << "VRStorm: DEBUG: UserHeadToEyeDepthMeters_Float               " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_UserHeadToEyeDepthMeters_Float              ); // 0.015
+            log(logger::level::debug) << "VRStorm: DEBUG: CameraFirmwareVersion_Uint64                 " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_CameraFirmwareVersion_Uint64                ); // 8590262285
+            log(logger::level::debug) << "VRStorm: DEBUG: CameraFirmwareDescription_String             " << get_tracked_device_string(                   i, vr::Prop_CameraFirmwareDescription_String            ); // Version: 02.05.0D Date: 2016.Feb.26
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayFPGAVersion_Uint64                    " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayFPGAVersion_Uint64                   ); // 57
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayBootloaderVersion_Uint64              " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayBootloaderVersion_Uint64             ); // 1048584
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplayHardwareVersion_Uint64                " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_DisplayHardwareVersion_Uint64               ); // 19
+            log(logger::level::debug) << "VRStorm: DEBUG: AudioFirmwareVersion_Uint64                  " << hmd_handle->GetUint64TrackedDeviceProperty(  i, vr::Prop_AudioFirmwareVersion_Uint64                 ); // 3
+            log(logger::level::debug) << "VRStorm: DEBUG: CameraCompatibilityMode_Int32                " << hmd_handle->GetInt32TrackedDeviceProperty(   i, vr::Prop_CameraCompatibilityMode_Int32               ); // 0
+            log(logger::level::debug) << "VRStorm: DEBUG: ScreenshotHorizontalFieldOfViewDegrees_Float " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_ScreenshotHorizontalFieldOfViewDegrees_Float); // 85
+            log(logger::level::debug) << "VRStorm: DEBUG: ScreenshotVerticalFieldOfViewDegrees_Float   " << hmd_handle->GetFloatTrackedDeviceProperty(   i, vr::Prop_ScreenshotVerticalFieldOfViewDegrees_Float  ); // 85
+            log(logger::level::debug) << "VRStorm: DEBUG: DisplaySuppressed_Bool                       " << hmd_handle->GetBoolTrackedDeviceProperty(    i, vr::Prop_DisplaySuppressed_Bool                      ); // false
             break;
           case vr::TrackedDeviceClass_Controller:                               // Tracked controllers
-            std::cout << "VRStorm: DEBUG: AttachedDeviceId_String " << get_tracked_device_string(                 i, vr::Prop_AttachedDeviceId_String) << std::endl;
-            std::cout << "VRStorm: DEBUG: SupportedButtons_Uint64 " << hmd_handle->GetUint64TrackedDeviceProperty(i, vr::Prop_SupportedButtons_Uint64) << std::endl;
-            std::cout << "VRStorm: DEBUG: Axis0Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis0Type_Int32        ) << std::endl;
-            std::cout << "VRStorm: DEBUG: Axis1Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis1Type_Int32        ) << std::endl;
-            std::cout << "VRStorm: DEBUG: Axis2Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis2Type_Int32        ) << std::endl;
-            std::cout << "VRStorm: DEBUG: Axis3Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis3Type_Int32        ) << std::endl;
-            std::cout << "VRStorm: DEBUG: Axis4Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis4Type_Int32        ) << std::endl;
+            log(logger::level::debug) << "VRStorm: DEBUG: AttachedDeviceId_String " << get_tracked_device_string(                 i, vr::Prop_AttachedDeviceId_String);
+            log(logger::level::debug) << "VRStorm: DEBUG: SupportedButtons_Uint64 " << hmd_handle->GetUint64TrackedDeviceProperty(i, vr::Prop_SupportedButtons_Uint64);
+            log(logger::level::debug) << "VRStorm: DEBUG: Axis0Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis0Type_Int32        );
+            log(logger::level::debug) << "VRStorm: DEBUG: Axis1Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis1Type_Int32        );
+            log(logger::level::debug) << "VRStorm: DEBUG: Axis2Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis2Type_Int32        );
+            log(logger::level::debug) << "VRStorm: DEBUG: Axis3Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis3Type_Int32        );
+            log(logger::level::debug) << "VRStorm: DEBUG: Axis4Type_Int32         " << hmd_handle->GetInt32TrackedDeviceProperty( i, vr::Prop_Axis4Type_Int32        );
             // above return value is of type EVRControllerAxisType
             break;
           case vr::TrackedDeviceClass_TrackingReference:                        // Camera and base stations that serve as tracking reference points
-            std::cout << "VRStorm: DEBUG: FieldOfViewLeftDegrees_Float     " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewLeftDegrees_Float    ) << std::endl;
-            std::cout << "VRStorm: DEBUG: FieldOfViewRightDegrees_Float    " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewRightDegrees_Float   ) << std::endl;
-            std::cout << "VRStorm: DEBUG: FieldOfViewTopDegrees_Float      " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewTopDegrees_Float     ) << std::endl;
-            std::cout << "VRStorm: DEBUG: FieldOfViewBottomDegrees_Float   " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewBottomDegrees_Float  ) << std::endl;
-            std::cout << "VRStorm: DEBUG: TrackingRangeMinimumMeters_Float " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_TrackingRangeMinimumMeters_Float) << std::endl;
-            std::cout << "VRStorm: DEBUG: TrackingRangeMaximumMeters_Float " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_TrackingRangeMaximumMeters_Float) << std::endl;
-            std::cout << "VRStorm: DEBUG: ModeLabel_String                 " << get_tracked_device_string(                i, vr::Prop_ModeLabel_String                ) << std::endl;
+            log(logger::level::debug) << "VRStorm: DEBUG: FieldOfViewLeftDegrees_Float     " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewLeftDegrees_Float    );
+            log(logger::level::debug) << "VRStorm: DEBUG: FieldOfViewRightDegrees_Float    " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewRightDegrees_Float   );
+            log(logger::level::debug) << "VRStorm: DEBUG: FieldOfViewTopDegrees_Float      " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewTopDegrees_Float     );
+            log(logger::level::debug) << "VRStorm: DEBUG: FieldOfViewBottomDegrees_Float   " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_FieldOfViewBottomDegrees_Float  );
+            log(logger::level::debug) << "VRStorm: DEBUG: TrackingRangeMinimumMeters_Float " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_TrackingRangeMinimumMeters_Float);
+            log(logger::level::debug) << "VRStorm: DEBUG: TrackingRangeMaximumMeters_Float " << hmd_handle->GetFloatTrackedDeviceProperty(i, vr::Prop_TrackingRangeMaximumMeters_Float);
+            log(logger::level::debug) << "VRStorm: DEBUG: ModeLabel_String                 " << get_tracked_device_string(                i, vr::Prop_ModeLabel_String                );
             break;
           default:
             break;
           }
-        #endif // DEBUG_VRSTORM
+        }
       }
 
       for(auto const &i : controller_ids) {
         // identify the attached controllers
-        controllers.emplace_back();
-        controllers.back().id = i;
-        std::cout << "VRStorm: Controller " << i;
-        switch(hmd_handle->GetControllerRoleForTrackedDeviceIndex(i)) {
-        case vr::TrackedControllerRole_LeftHand:
-          std::cout << " (left): " << std::endl;
-          controllers.back().hand = input::controller::hand_type::LEFT;
-          break;
-        case vr::TrackedControllerRole_RightHand:
-          std::cout << " (right): " << std::endl;
-          controllers.back().hand = input::controller::hand_type::RIGHT;
-          break;
-        case vr::TrackedControllerRole_Invalid:
-        default:
-          std::cout << ": " << std::endl;
-          controllers.back().hand = input::controller::hand_type::UNKNOWN;
-          break;
+        {
+          auto line(log(logger::level::info));
+          line << "VRStorm: Controller " << i;
+          switch(hmd_handle->GetControllerRoleForTrackedDeviceIndex(i)) {
+          case vr::TrackedControllerRole_LeftHand:
+            line << " (left): ";
+            break;
+          case vr::TrackedControllerRole_RightHand:
+            line << " (right): ";
+            break;
+          case vr::TrackedControllerRole_Invalid:
+          default:
+            line << ": ";
+            break;
+          }
         }
         for(unsigned int axis = 0; axis != vr::Prop_Axis4Type_Int32 - vr::Prop_Axis0Type_Int32; ++axis) {
           vr::EVRControllerAxisType const controller_axis_type = static_cast<vr::EVRControllerAxisType>(hmd_handle->GetInt32TrackedDeviceProperty(i, static_cast<vr::ETrackedDeviceProperty>(vr::Prop_Axis0Type_Int32 + axis)));
           switch(controller_axis_type) {
           case vr::k_eControllerAxis_None:
-            //std::cout << "VRStorm:   axis " << axis << ": " << hmd_handle->GetControllerAxisTypeNameFromEnum(controller_axis_type) << " is not there" << std::endl;
+            //log(logger::level::info) << "VRStorm:   axis " << axis << ": " << hmd_handle->GetControllerAxisTypeNameFromEnum(controller_axis_type) << " is not there";
             break;
           case vr::k_eControllerAxis_TrackPad:
-            std::cout << "VRStorm:   axis " << axis << " is a trackpad" << std::endl;
+            log(logger::level::info) << "VRStorm:   axis " << axis << " is a trackpad";
             break;
           case vr::k_eControllerAxis_Joystick:
-            std::cout << "VRStorm:   axis " << axis << " is a joystick" << std::endl;
+            log(logger::level::info) << "VRStorm:   axis " << axis << " is a joystick";
             break;
           case vr::k_eControllerAxis_Trigger:                                   // analogue trigger data is in the X axis
-            std::cout << "VRStorm:   axis " << axis << " is a trigger" << std::endl;
+            log(logger::level::info) << "VRStorm:   axis " << axis << " is a trigger";
             break;
           }
         }
         /*
         // the below is only useful for button events
         for(uint_fast64_t button = 0; button != std::min(static_cast<uint_fast64_t>(vr::k_EButton_Max), hmd_handle->GetUint64TrackedDeviceProperty(i, vr::Prop_SupportedButtons_Uint64)); ++button) {
-          std::cout << "VRStorm:   button " << button << ": " << hmd_handle->GetButtonIdNameFromEnum(static_cast<vr::EVRButtonId>(button)) << std::endl;
+          log(logger::level::info) << "VRStorm:   button " << button << ": " << hmd_handle->GetButtonIdNameFromEnum(static_cast<vr::EVRButtonId>(button));
         }
         */
       }
       if(hmd_handle->IsInputFocusCapturedByAnotherProcess()) {
-        std::cout << "VRStorm: Input focus is currently held by another process." << std::endl;
-      } else {
-        std::cout << "VRStorm: Input focus is available for capture." << std::endl;
-      }
-      input_controller.init();
-      input_controller.update_hands();
-      input_controller.update_names();
-
-      // get render models if available, the following replaces vr::IVRRenderModels *render_models = vr::VRRenderModels();
-      vr::IVRRenderModels *render_models = static_cast<vr::IVRRenderModels*>(VR_GetGenericInterface(vr::IVRRenderModels_Version, &vr_error));
-      if(render_models) {
-        for(auto &it : controllers) {                                           // load models for controllers
-          std::string const render_model_name(get_tracked_device_string(it.id, vr::Prop_RenderModelName_String));
-          vr::RenderModel_t *&model = models[render_model_name];
-          if(model) {
-            std::cout << "VRStorm: Device " << it.id << " shares already loaded render model: " << render_model_name << std::endl;
-          } else {
-            std::cout << "VRStorm: Loading device " << it.id << "'s render model: " << render_model_name << "...";
-            vr::EVRRenderModelError model_load_error = render_models->LoadRenderModel_Async(render_model_name.c_str(), &model);
-            while(model_load_error == vr::VRRenderModelError_Loading) {
-              std::this_thread::sleep_for(std::chrono::milliseconds(100));      // just sleep-wait for the models to load
-              std::cout << ".";
-              model_load_error = render_models->LoadRenderModel_Async(render_model_name.c_str(), &model);
-            }
-            // TODO: make this async to speed up loading
-            if(model_load_error != vr::VRRenderModelError_None || !model) {
-              std::cout << std::endl;
-              std::cout << "VRStorm: Failed to load device " << it.id << "'s render model: " << render_model_name << std::endl;
-              continue;
-            }
-            std::cout << " done, " << model->unVertexCount << " verts, " << model->unTriangleCount << " tris" << std::endl;
-          }
-          it.model = model;
-        }
-        // this works, but no need to implement it yet:
-        /*
-        for(unsigned int i = 0; i != render_models->GetRenderModelCount(); ++i) {
-          size_t buffer_len = render_models->GetRenderModelName(i, nullptr, 0);
-          std::string buffer(buffer_len, '\0');
-          render_models->GetRenderModelName(i, &buffer[0], cast_if_required<uint32_t>(buffer.size()));
-          std::cout << "VRStorm: Render model " << i << ": \"" << buffer << "\"" << std::endl;
-        }
-        */
+        log(logger::level::info) << "VRStorm: Input focus is currently held by another process.";
       } else {
-        std::cout << "VRStorm: Unable to get render model interface: " << VR_GetVRInitErrorAsEnglishDescription(vr_error) << std::endl; // this is not a fatal error - we just carry on
-      }
-
-      // grab the initial poses
-      enabled = true;
-      update();
-      {
-        vec3f const head_position(hmd_position.get_translation());
-        if(head_position.y == 0.0f) {
-          std::cout << "VRStorm: HMD initial position is invalid, defaulting to " << head_height << "m starting head height" << std::endl;
-        } else {
-          head_height = -head_position.y;
-          std::cout << "VRStorm: Starting head height is " << head_height << "m" << std::endl;
-        }
+        log(logger::level::info) << "VRStorm: Input focus is available for capture.";
       }
-      std::cout << "VRStorm: Successfully initialised." << std::endl;
     } catch(std::exception &e) {
-      std::cout << "VRStorm: Exception at startup: " << e.what() << std::endl;
-      shutdown();
+      log(logger::level::error) << "VRStorm: Exception logging diagnostics: " << e.what();
     }
-  #else
-    std::cout << "VRStorm: VR is disabled in this build." << std::endl;
-  #endif // VRSTORM_DISABLED
-}
+  }
+#endif // VRSTORM_DISABLED
 
 void manager::shutdown() {
   /// Shut down the VR system
+  stop_frame_thread();
   #ifndef VRSTORM_DISABLED
-    if(lib && enabled) {
-      std::cout << "VRStorm: Shutting down." << std::endl;
-      try {
-        auto VR_ShutdownInternal = load_symbol<decltype(&vr::VR_ShutdownInternal)>(lib, "VR_ShutdownInternal");
-        if(VR_ShutdownInternal) {
-          VR_ShutdownInternal();
-        }
-      } catch(std::exception &e) {
-        std::cout << "VRStorm: Exception at shutdown: " << e.what() << std::endl;
+    model_cache.shutdown();
+    delete_array_texture_views();
+    hidden_area.shutdown();
+    delete_late_latch_buffer();
+    model_loader.shutdown();                                                    // models must be freed while the runtime is still up
+    diagnostics_pending = false;
+    stop_recording();
+    controllers.clear();
+    trackers.clear();
+    devices.clear();
+    if(enabled) {
+      log(logger::level::info) << "VRStorm: Shutting down.";
+      if(symbols.VR_ShutdownInternal) {
+        symbols.VR_ShutdownInternal();                                          // resolved at startup
       }
       hmd_handle = nullptr;
     }
-    models.clear();
+    symbols.clear();
+    replay.close();                                                             // only after the stub has stopped serving from it
+    backend = backend_type::OPENVR;
   #endif // VRSTORM_DISABLED
   unload_dynamic(lib);
   enabled = false;
@@ -545,356 +597,618 @@ void manager::shutdown() {
 
 void manager::update() {
   #ifndef VRSTORM_DISABLED
-    if(!enabled) {
+    if(!enabled || frame_thread_running.load(std::memory_order_relaxed)) {     // the frame thread updates on its own
       return;
     }
+    if(backend == backend_type::REPLAY) {
+      stub.advance();                                                           // each update replays the next recorded frame
+    }
     std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> tracked_device_poses;
-    compositor->WaitGetPoses(tracked_device_poses.data(), vr::k_unMaxTrackedDeviceCount, nullptr, 0);
-    if(tracked_device_poses[vr::k_unTrackedDeviceIndex_Hmd].bPoseIsValid) {     // update HMD state
-      hmd_position = mat4f::from_row_major_34_array(*tracked_device_poses[vr::k_unTrackedDeviceIndex_Hmd].mDeviceToAbsoluteTracking.m).inverse();
+    auto const time_start(std::chrono::steady_clock::now());
+    switch(pose_mode) {
+    case pose_mode_type::WAIT:                                                  // block until the compositor hands us the poses to render with
+      compositor->WaitGetPoses(tracked_device_poses.data(), vr::k_unMaxTrackedDeviceCount, nullptr, 0);
+      break;
+    case pose_mode_type::PREDICTED:                                             // predict poses for when this frame reaches the display, without blocking
+      hmd_handle->GetDeviceToAbsoluteTrackingPose(tracking_space, get_seconds_to_photons(), tracked_device_poses.data(), vr::k_unMaxTrackedDeviceCount);
+      break;
     }
-    for(auto &it : controllers) {                                               // update controller states
-      if(tracked_device_poses[it.id].bPoseIsValid) {
-        it.position = mat4f::from_row_major_34_array(*tracked_device_poses[it.id].mDeviceToAbsoluteTracking.m);
+    current_frame_timing.wait_ms += milliseconds_since(time_start);
+    recorder.record_frame(tracked_device_poses);                                // events and controller states that follow are recorded with these poses
+    auto const time_poses(std::chrono::steady_clock::now());
+    update_poses(tracked_device_poses);
+    current_frame_timing.update_ms += milliseconds_since(time_poses);
+    update_events();
+    record_frame_timing();
+  #endif // VRSTORM_DISABLED
+}
+
+void manager::update_events() {
+  /// Dispatch events and poll controller axes
+  #ifndef VRSTORM_DISABLED
+    auto const time_start(std::chrono::steady_clock::now());
+    vr::VREvent_t event;
+    while(hmd_handle->PollNextEvent(&event, sizeof(event))) {                   // poll for any new events in the queue
+      if(log.enabled(logger::level::trace)) {                                   // avoid looking up the name unless it'll be logged
+        log(logger::level::trace) << "VRStorm: TRACE: polled an event: " << hmd_handle->GetEventTypeNameFromEnum(static_cast<vr::EVREventType>(event.eventType)) << " on device " << static_cast<int64_t>(event.trackedDeviceIndex);
       }
+      recorder.record_event(event);
+      dispatch_event(event);
     }
 
-    float const new_ipd = hmd_handle->GetFloatTrackedDeviceProperty(0, vr::Prop_UserIpdMeters_Float);
-    if(ipd != new_ipd) {                                                        // cache the new eye to head transforms only when IPD changes
-      if(ipd == 0.0f) {
-        std::cout << "VRStorm: Inter-pupillary distance set to " << new_ipd * 1000.0f << "mm" << std::endl;
-      } else {
-        std::cout << "VRStorm: Inter-pupillary distance changed from " << ipd * 1000.0f << "mm to " << new_ipd * 1000.0f << "mm" << std::endl;
-      }
-      ipd = new_ipd;
-      eye_to_head_transform[static_cast<unsigned int>(vr::EVREye::Eye_Left )] = mat4f::from_row_major_34_array(*hmd_handle->GetEyeToHeadTransform(vr::EVREye::Eye_Left ).m).inverse();
-      eye_to_head_transform[static_cast<unsigned int>(vr::EVREye::Eye_Right)] = mat4f::from_row_major_34_array(*hmd_handle->GetEyeToHeadTransform(vr::EVREye::Eye_Right).m).inverse();
+    auto const time_events(std::chrono::steady_clock::now());
+    current_frame_timing.events_ms += std::chrono::duration<float, std::milli>(time_events - time_start).count();
+
+    // poll and update the analogue controller axes
+    input_controller.poll();
+    current_frame_timing.poll_ms += milliseconds_since(time_events);
+
+    // pick up any render models that have finished loading
+    model_loader.update();
+
+    if(diagnostics_pending) {
+      diagnostics_pending = false;
+      log_diagnostics();                                                        // deferred from init(), on the thread that owns the runtime
     }
+  #endif // VRSTORM_DISABLED
+}
 
-    vr::VREvent_t event;
-    while(hmd_handle->PollNextEvent(&event, sizeof(event))) {                   // poll for any new events in the queue
-      #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        std::cout << "VRStorm: DEBUG: polled an event: " << hmd_handle->GetEventTypeNameFromEnum(static_cast<vr::EVREventType>(event.eventType)) << " on device " << static_cast<int64_t>(event.trackedDeviceIndex) << std::endl;
-      #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-      switch(event.eventType) {
-      case vr::VREvent_None:
-        break;
-      case vr::VREvent_TrackedDeviceActivated:                                  // when a new device is activated / connected
-        #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-          std::cout << "VRStorm: DEBUG: controller id " << event.trackedDeviceIndex << " has been activated." << std::endl;
-        #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        // TODO: update the tracked device listings
-        input_controller.update_hands();
-        input_controller.update_names();
-        break;
-      case vr::VREvent_TrackedDeviceDeactivated:                                // when a device is deactivated / disconnected
-        #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-          std::cout << "VRStorm: DEBUG: controller id " << event.trackedDeviceIndex << " has been deactivated." << std::endl;
-        #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        // TODO: update the tracked device listings
-        input_controller.update_hands();
-        input_controller.update_names();
-        break;
-      case vr::VREvent_TrackedDeviceUpdated:
-        break;
-      case vr::VREvent_TrackedDeviceUserInteractionStarted:                     // when the headset wakes up
-        break;
-      case vr::VREvent_TrackedDeviceUserInteractionEnded:                       // when the headset goes to sleep
-        break;
-      case vr::VREvent_IpdChanged:
-        break;
-      case vr::VREvent_EnterStandbyMode:                                        // when the headset goes to sleep
-        break;
-      case vr::VREvent_LeaveStandbyMode:                                        // when the headset wakes up
-        break;
-      case vr::VREvent_TrackedDeviceRoleChanged:
-        break;
-      // input:
-      case vr::VREvent_ButtonPress:                                             // data is controller
-        {
-          unsigned int const button = event.data.controller.button;
-          switch(hmd_handle->GetControllerRoleForTrackedDeviceIndex(event.trackedDeviceIndex)) {
-          case vr::TrackedControllerRole_LeftHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " press on left controller begin" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            if(input_controller.get_id(input::controller::hand_type::LEFT) != event.trackedDeviceIndex) {
-              // the handedness of this report does not agree with our cached controller roles - need to recache them
-              input_controller.update_hands();
-            }
-            input_controller.execute_button(input::controller::hand_type::LEFT, button, input::controller::actiontype::PRESS);
-            break;
-          case vr::TrackedControllerRole_RightHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " press on right controller begin" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            if(input_controller.get_id(input::controller::hand_type::RIGHT) != event.trackedDeviceIndex) {
-              // the handedness of this report does not agree with our cached controller roles - need to recache them
-              input_controller.update_hands();
-            }
-            input_controller.execute_button(input::controller::hand_type::RIGHT, button, input::controller::actiontype::PRESS);
-            break;
-          default:
-            std::cout << "VRStorm: WARNING: button " << button << " press on unknown controller begin!" << std::endl;
-            break;
-          }
-        }
-        break;
-      case vr::VREvent_ButtonUnpress:                                           // data is controller
-        {
-          unsigned int const button = event.data.controller.button;
-          switch(hmd_handle->GetControllerRoleForTrackedDeviceIndex(event.trackedDeviceIndex)) {
-          case vr::TrackedControllerRole_LeftHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " press on left controller end" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            input_controller.execute_button(input::controller::hand_type::LEFT, button, input::controller::actiontype::RELEASE);
-            break;
-          case vr::TrackedControllerRole_RightHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " press on right controller end" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            input_controller.execute_button(input::controller::hand_type::RIGHT, button, input::controller::actiontype::RELEASE);
-            break;
-          default:
-            std::cout << "VRStorm: WARNING: button " << button << " press on unknown controller end!" << std::endl;
-            break;
-          }
+void manager::wait_for_frame() {
+  /// Block until the compositor is ready for the next frame, and update poses to the ones it will render with - only in predicted pose mode, otherwise does nothing
+  #ifndef VRSTORM_DISABLED
+    if(!enabled || frame_thread_running.load(std::memory_order_relaxed)) {     // the frame thread waits on its own
+      return;
+    }
+    if(pose_mode != pose_mode_type::PREDICTED) {                                // update() already waited, waiting again would block for a second frame
+      return;
+    }
+    std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> tracked_device_poses;
+    auto const time_start(std::chrono::steady_clock::now());
+    compositor->WaitGetPoses(tracked_device_poses.data(), vr::k_unMaxTrackedDeviceCount, nullptr, 0);
+    current_frame_timing.wait_ms += milliseconds_since(time_start);             // counted towards the next recorded frame
+    recorder.record_render_poses(tracked_device_poses);                         // alongside the predicted poses update() recorded, so replay renders with these
+    auto const time_poses(std::chrono::steady_clock::now());
+    update_poses(tracked_device_poses);
+    current_frame_timing.update_ms += milliseconds_since(time_poses);
+  #endif // VRSTORM_DISABLED
+}
+
+#ifndef VRSTORM_DISABLED
+  void manager::update_poses(std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> const &tracked_device_poses) {
+    /// Update the HMD and controller positions from an array of tracked device poses
+    tracked_poses.update(tracked_device_poses);                                 // convert all devices in one pass
+    if(tracked_poses.get_valid(vr::k_unTrackedDeviceIndex_Hmd)) {               // update HMD state
+      hmd_pose = tracked_poses.get_pose(vr::k_unTrackedDeviceIndex_Hmd);
+      hmd_pose.inverse().to_mat4(hmd_position);                                 // rigid inverse, no need for a general 4x4 inverse
+    }
+    for(auto *list : {&controllers, &trackers}) {                               // update controller and tracker states
+      for(auto &it : *list) {
+        if(tracked_poses.get_valid(it.id)) {
+          it.pose = tracked_poses.get_pose(it.id);
+          it.pose.to_mat4(it.position);
         }
-        break;
-      case vr::VREvent_ButtonTouch:                                             // data is controller
-        {
-          unsigned int const button = event.data.controller.button;
-          switch(hmd_handle->GetControllerRoleForTrackedDeviceIndex(event.trackedDeviceIndex)) {
-          case vr::TrackedControllerRole_LeftHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " touch on left controller begin" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            input_controller.execute_button(input::controller::hand_type::LEFT, button, input::controller::actiontype::TOUCH);
-            break;
-          case vr::TrackedControllerRole_RightHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " touch on right controller begin" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            input_controller.execute_button(input::controller::hand_type::RIGHT, button, input::controller::actiontype::TOUCH);
-            break;
-          default:
-            std::cout << "VRStorm: WARNING: button " << button << " touch on unknown controller begin!" << std::endl;
-            break;
-          }
+      }
+    }
+    update_eye_matrices();
+  }
+
+  void manager::update_ipd(float new_ipd) {
+    /// Cache the new eye to head transforms only when IPD changes
+    if(ipd == new_ipd) {
+      return;
+    }
+    if(ipd == 0.0f) {
+      log(logger::level::info) << "VRStorm: Inter-pupillary distance set to " << new_ipd * 1000.0f << "mm";
+    } else {
+      log(logger::level::info) << "VRStorm: Inter-pupillary distance changed from " << ipd * 1000.0f << "mm to " << new_ipd * 1000.0f << "mm";
+    }
+    ipd = new_ipd;
+    eye_to_head_transform[static_cast<unsigned int>(vr::EVREye::Eye_Left )] = rigid_pose::from_row_major_34_array(*hmd_handle->GetEyeToHeadTransform(vr::EVREye::Eye_Left ).m).inverse().to_mat4();
+    eye_to_head_transform[static_cast<unsigned int>(vr::EVREye::Eye_Right)] = rigid_pose::from_row_major_34_array(*hmd_handle->GetEyeToHeadTransform(vr::EVREye::Eye_Right).m).inverse().to_mat4();
+  }
+
+  void manager::record_frame_timing() {
+    /// Combine this frame's own timings with the compositor's, and push them to the timing ring
+    vr::Compositor_FrameTiming timing;
+    timing.m_nSize = sizeof(timing);
+    if(compositor->GetFrameTiming(&timing, 0)) {
+      current_frame_timing.frame_index              = timing.m_nFrameIndex;
+      current_frame_timing.gpu_ms                   = timing.m_flTotalRenderGpuMs;
+      current_frame_timing.compositor_cpu_ms        = timing.m_flCompositorRenderCpuMs;
+      current_frame_timing.client_frame_interval_ms = timing.m_flClientFrameIntervalMs;
+      current_frame_timing.frame_presents           = timing.m_nNumFramePresents;
+      current_frame_timing.dropped_frames           = timing.m_nNumDroppedFrames;
+      current_frame_timing.reprojection_flags       = timing.m_nReprojectionFlags;
+      resolution.update(timing.m_flTotalRenderGpuMs, frame_duration * 1000.0f);
+    }
+    vr::Compositor_CumulativeStats stats;
+    compositor->GetCumulativeStats(&stats, sizeof(stats));
+    current_frame_timing.total_frame_presents     = stats.m_nNumFramePresents;
+    current_frame_timing.total_dropped_frames     = stats.m_nNumDroppedFrames;
+    current_frame_timing.total_reprojected_frames = stats.m_nNumReprojectedFrames;
+    current_frame_timing.fence_wait_ms = last_fence_wait_ms.exchange(0.0f, std::memory_order_relaxed);
+    frame_timings.push(current_frame_timing);
+    current_frame_timing = frame_timing_sample();
+  }
+
+  void manager::update_projection() {
+    /// Cache the projection matrices for the current near and far planes
+    for(auto const eye : {vr::Eye_Left, vr::Eye_Right}) {
+      eye_camera[static_cast<unsigned int>(eye)].projection = mat4f::from_row_major_array(*hmd_handle->GetProjectionMatrix(eye, nearplane, farplane, vr::API_OpenGL).m);
+    }
+    projection_nearplane = nearplane;
+    projection_farplane  = farplane;
+  }
+
+  void manager::update_eye_matrices() {
+    /// Recompute each eye's view and view-projection from the current head position
+    if(nearplane != projection_nearplane || farplane != projection_farplane) {
+      update_projection();                                                      // only when the planes or the device have changed
+    }
+    // Order: Model * View * Eye^-1 * Projection.
+    for(unsigned int eye = 0; eye != eye_camera.size(); ++eye) {
+      eye_camera[eye].view            = eye_to_head_transform[eye] * hmd_position;
+      eye_camera[eye].view_projection = eye_camera[eye].projection * eye_camera[eye].view;
+    }
+  }
+
+  void manager::refresh_device_properties(vr::TrackedDeviceIndex_t device_index) {
+    /// Query the runtime for every property we use on this device, and cache them
+    if(device_index >= vr::k_unMaxTrackedDeviceCount) {
+      return;
+    }
+    tracked_device_properties &properties = device_properties[device_index];
+    properties.device_class         = hmd_handle->GetTrackedDeviceClass(device_index);
+    properties.role                 = hmd_handle->GetControllerRoleForTrackedDeviceIndex(device_index);
+    properties.tracking_system_name = get_tracked_device_string(device_index, vr::Prop_TrackingSystemName_String);
+    properties.manufacturer_name    = get_tracked_device_string(device_index, vr::Prop_ManufacturerName_String);
+    properties.model_number         = get_tracked_device_string(device_index, vr::Prop_ModelNumber_String);
+    properties.serial_number        = get_tracked_device_string(device_index, vr::Prop_SerialNumber_String);
+    properties.render_model_name    = get_tracked_device_string(device_index, vr::Prop_RenderModelName_String);
+    switch(properties.device_class) {
+    case vr::TrackedDeviceClass_HMD:
+      properties.user_ipd             = hmd_handle->GetFloatTrackedDeviceProperty(device_index, vr::Prop_UserIpdMeters_Float);
+      properties.display_frequency    = hmd_handle->GetFloatTrackedDeviceProperty(device_index, vr::Prop_DisplayFrequency_Float);
+      properties.vsync_to_photon_time = hmd_handle->GetFloatTrackedDeviceProperty(device_index, vr::Prop_SecondsFromVsyncToPhotons_Float);
+      break;
+    case vr::TrackedDeviceClass_Controller:
+      properties.supported_buttons = hmd_handle->GetUint64TrackedDeviceProperty(device_index, vr::Prop_SupportedButtons_Uint64);
+      properties.axis_mask = 0;
+      for(unsigned int axis = 0; axis != properties.axis_types.size(); ++axis) {
+        properties.axis_types[axis] = static_cast<vr::EVRControllerAxisType>(hmd_handle->GetInt32TrackedDeviceProperty(device_index, static_cast<vr::ETrackedDeviceProperty>(vr::Prop_Axis0Type_Int32 + axis)));
+        if(properties.axis_types[axis] != vr::k_eControllerAxis_None) {
+          properties.axis_mask |= 1u << axis;
         }
-        break;
-      case vr::VREvent_ButtonUntouch:                                           // data is controller
-        {
-          unsigned int const button = event.data.controller.button;
-          switch(hmd_handle->GetControllerRoleForTrackedDeviceIndex(event.trackedDeviceIndex)) {
-          case vr::TrackedControllerRole_LeftHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " touch on left controller end" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            input_controller.execute_button(input::controller::hand_type::LEFT, button, input::controller::actiontype::UNTOUCH);
-            break;
-          case vr::TrackedControllerRole_RightHand:
-            #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-              std::cout << "VRStorm: DEBUG: button " << button << " touch on right controller end" << std::endl;
-            #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            input_controller.execute_button(input::controller::hand_type::RIGHT, button, input::controller::actiontype::UNTOUCH);
-            break;
-          default:
-            std::cout << "VRStorm: WARNING: button " << button << " touch on unknown controller end!" << std::endl;
-            break;
-          }
-        }
-        break;
-      case vr::VREvent_MouseMove:                                               // data is mouse
-        break;
-      case vr::VREvent_MouseButtonDown:                                         // data is mouse
-        break;
-      case vr::VREvent_MouseButtonUp:                                           // data is mouse
-        break;
-      case vr::VREvent_FocusEnter:                                              // data is overlay
-        break;
-      case vr::VREvent_FocusLeave:                                              // data is overlay
-        break;
-      case vr::VREvent_Scroll:                                                  // data is mouse
-        break;
-      case vr::VREvent_TouchPadMove:                                            // data is mouse
-        break;
-      case vr::VREvent_InputFocusCaptured:                                      // data is process DEPRECATED
-        break;
-      case vr::VREvent_InputFocusReleased:                                      // data is process DEPRECATED
-        break;
-      case vr::VREvent_SceneFocusLost:                                          // data is process
-        break;
-      case vr::VREvent_SceneFocusGained:                                        // data is process
-        break;
-      case vr::VREvent_SceneApplicationChanged:                                 // data is process - The App actually drawing the scene changed (usually to or from the compositor)
-        break;
-      case vr::VREvent_SceneFocusChanged:                                       // data is process - New app got access to draw the scene
-        break;
-      case vr::VREvent_InputFocusChanged:                                       // data is process
-        break;
-      case vr::VREvent_SceneApplicationSecondaryRenderingStarted:               // data is process
-        break;
-      case vr::VREvent_HideRenderModels:                                        // Sent to the scene application to request hiding render models temporarily
-        break;
-      case vr::VREvent_ShowRenderModels:                                        // Sent to the scene application to request restoring render model visibility
-        break;
-      case vr::VREvent_OverlayShown:
-        break;
-      case vr::VREvent_OverlayHidden:
-        break;
-      case vr::VREvent_DashboardActivated:                                      // user opens the dashboard, i.e. with hmd button
-        break;
-      case vr::VREvent_DashboardDeactivated:                                    // user closes the dashboard, i.e. with hmd button
-        break;
-      case vr::VREvent_DashboardThumbSelected:                                  // Sent to the overlay manager - data is overlay
-        break;
-      case vr::VREvent_DashboardRequested:                                      // Sent to the overlay manager - data is overlay
-        break;
-      case vr::VREvent_ResetDashboard:                                          // Send to the overlay manager
-        break;
-      case vr::VREvent_RenderToast:                                             // Send to the dashboard to render a toast - data is the notification ID
-        break;
-      case vr::VREvent_ImageLoaded:                                             // Sent to overlays when a SetOverlayRaw or SetOverlayFromFile call finishes loading
-        break;
-      case vr::VREvent_ShowKeyboard:                                            // Sent to keyboard renderer in the dashboard to invoke it
-        break;
-      case vr::VREvent_HideKeyboard:                                            // Sent to keyboard renderer in the dashboard to hide it
-        break;
-      case vr::VREvent_OverlayGamepadFocusGained:                               // Sent to an overlay when IVROverlay::SetFocusOverlay is called on it
-        break;
-      case vr::VREvent_OverlayGamepadFocusLost:                                 // Send to an overlay when it previously had focus and IVROverlay::SetFocusOverlay is called on something else
-        break;
-      case vr::VREvent_OverlaySharedTextureChanged:
-        break;
-      case vr::VREvent_DashboardGuideButtonDown:
-        break;
-      case vr::VREvent_DashboardGuideButtonUp:
-        break;
-      case vr::VREvent_ScreenshotTriggered:                                     // Screenshot button combo was pressed, Dashboard should request a screenshot
-        break;
-      case vr::VREvent_ImageFailed:                                             // Sent to overlays when a SetOverlayRaw or SetOverlayfromFail fails to load
-        break;
-      // screenshot API:
-      case vr::VREvent_RequestScreenshot:                                       // Sent by vrclient application to compositor to take a screenshot
-        break;
-      case vr::VREvent_ScreenshotTaken:                                         // Sent by compositor to the application that the screenshot has been taken
-        break;
-      case vr::VREvent_ScreenshotFailed:                                        // Sent by compositor to the application that the screenshot failed to be taken
-        break;
-      case vr::VREvent_SubmitScreenshotToDashboard:                             // Sent by compositor to the dashboard that a completed screenshot was submitted
-        break;
-      case vr::VREvent_Notification_Shown:
-        break;
-      case vr::VREvent_Notification_Hidden:
-        break;
-      case vr::VREvent_Notification_BeginInteraction:
-        break;
-      case vr::VREvent_Notification_Destroyed:
-        break;
-      case vr::VREvent_Quit:                                                    // data is process
-        break;
-      case vr::VREvent_ProcessQuit:                                             // data is process
-        break;
-      case vr::VREvent_QuitAborted_UserPrompt:                                  // data is process
-        break;
-      case vr::VREvent_QuitAcknowledged:                                        // data is process
-        break;
-      case vr::VREvent_DriverRequestedQuit:                                     // The driver has requested that SteamVR shut down
-        break;
-      case vr::VREvent_ChaperoneDataHasChanged:
-        break;
-      case vr::VREvent_ChaperoneUniverseHasChanged:
-        break;
-      case vr::VREvent_ChaperoneTempDataHasChanged:
-        break;
-      case vr::VREvent_ChaperoneSettingsHaveChanged:
-        break;
-      case vr::VREvent_SeatedZeroPoseReset:
-        break;
-      case vr::VREvent_AudioSettingsHaveChanged:
-        break;
-      case vr::VREvent_BackgroundSettingHasChanged:
-        break;
-      case vr::VREvent_CameraSettingsHaveChanged:
-        break;
-      case vr::VREvent_ReprojectionSettingHasChanged:
-        break;
-      case vr::VREvent_ModelSkinSettingsHaveChanged:
-        break;
-      case vr::VREvent_EnvironmentSettingsHaveChanged:
-        break;
-      case vr::VREvent_StatusUpdate:
-        break;
-      case vr::VREvent_MCImageUpdated:
-        break;
-      case vr::VREvent_FirmwareUpdateStarted:
-        break;
-      case vr::VREvent_FirmwareUpdateFinished:
-        break;
-      case vr::VREvent_KeyboardClosed:
-        break;
-      case vr::VREvent_KeyboardCharInput:
-        break;
-      case vr::VREvent_KeyboardDone:                                            // Sent when DONE button clicked on keyboard
-        break;
-      case vr::VREvent_ApplicationTransitionStarted:
-        break;
-      case vr::VREvent_ApplicationTransitionAborted:
-        break;
-      case vr::VREvent_ApplicationTransitionNewAppStarted:
-        break;
-      case vr::VREvent_ApplicationListUpdated:
-        break;
-      case vr::VREvent_Compositor_MirrorWindowShown:
-        break;
-      case vr::VREvent_Compositor_MirrorWindowHidden:
-        break;
-      case vr::VREvent_Compositor_ChaperoneBoundsShown:
-        break;
-      case vr::VREvent_Compositor_ChaperoneBoundsHidden:
-        break;
-      case vr::VREvent_TrackedCamera_StartVideoStream:
-        break;
-      case vr::VREvent_TrackedCamera_StopVideoStream:
-        break;
-      case vr::VREvent_TrackedCamera_PauseVideoStream:
-        break;
-      case vr::VREvent_TrackedCamera_ResumeVideoStream:
-        break;
-      case vr::VREvent_PerformanceTest_EnableCapture:
-        break;
-      case vr::VREvent_PerformanceTest_DisableCapture:
-        break;
-      case vr::VREvent_PerformanceTest_FidelityLevel:
-        break;
-      case vr::VREvent_VendorSpecific_Reserved_Start:                           // Vendors are free to expose private events in this reserved region
-      case vr::VREvent_VendorSpecific_Reserved_End:
-      default:
-        if(event.eventType >= vr::VREvent_VendorSpecific_Reserved_Start &&
-           event.eventType <= vr::VREvent_VendorSpecific_Reserved_End) {
-          #if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            std::cout << "VRStorm: Received a vendor specific event on device " << event.trackedDeviceIndex << ", type " << event.eventType << std::endl;
-          #endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        } else {
-          //#if defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-            std::cout << "VRStorm: Received an unknown event on device " << event.trackedDeviceIndex << ", type " << event.eventType << std::endl;
-          //#endif // defined(DEBUG_VRSTORM) || defined(DEBUG_INPUTSTORM)
-        }
-        break;
       }
+      break;
+    default:
+      break;
+    }
+    devices.set_role(device_index, properties.role);                           // only if it's registered
+    if(controller *const this_controller = find_tracked_device(device_index)) {
+      this_controller->hand = devices.get_hand(device_index);
     }
+    properties.cached = true;
+  }
 
-    // poll and update the analogue controller axes
-    input_controller.poll();
+  void manager::refresh_device_roles() {
+    /// Re-query the roles of registered controllers only, for when roles have been swapped, and move the hands of those that changed
+    for(uint64_t remaining = devices.get_class_mask(vr::TrackedDeviceClass_Controller); remaining != 0; remaining &= remaining - 1) {
+      vr::TrackedDeviceIndex_t const device_index = static_cast<vr::TrackedDeviceIndex_t>(__builtin_ctzll(remaining));
+      vr::ETrackedControllerRole const role = hmd_handle->GetControllerRoleForTrackedDeviceIndex(device_index);
+      if(role == devices.get_role(device_index)) {
+        continue;
+      }
+      device_properties[device_index].role = role;
+      devices.set_role(device_index, role);
+      if(controller *const this_controller = find_tracked_device(device_index)) {
+        this_controller->hand = devices.get_hand(device_index);
+      }
+      input_controller.update_device(device_index);
+    }
+  }
+
+  void manager::invalidate_device_properties(vr::TrackedDeviceIndex_t device_index) {
+    /// Forget the cached properties of a device, so they're queried again next time they're needed
+    if(device_index >= vr::k_unMaxTrackedDeviceCount) {
+      return;
+    }
+    device_properties[device_index] = tracked_device_properties();
+  }
+
+  void manager::add_tracked_device(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceClass device_class) {
+    /// Register a connected device, giving controllers and trackers a place in their list so they get poses
+    if(device_index >= vr::k_unMaxTrackedDeviceCount) {
+      return;
+    }
+    if(devices.get_connected(device_index)) {
+      remove_tracked_device(device_index);                                      // activated again, perhaps as a different class
+    }
+    vr::ETrackedControllerRole const role = device_properties[device_index].cached ? device_properties[device_index].role : vr::TrackedControllerRole_Invalid;
+    unsigned int slot = device_registry::no_slot;
+    if(std::vector<controller> *const list = get_device_list(device_class)) {
+      slot = static_cast<unsigned int>(list->size());
+      list->emplace_back();
+      list->back().id = device_index;
+      list->back().hand = input::controller::get_hand_from_role(role);
+    }
+    devices.add(device_index, device_class, role, slot);
+  }
+
+  void manager::remove_tracked_device(vr::TrackedDeviceIndex_t device_index) {
+    /// Unregister a disconnected device, moving the last of its list into its place
+    if(!devices.get_connected(device_index)) {
+      return;
+    }
+    if(std::vector<controller> *const list = get_device_list(devices.get_class(device_index))) {
+      unsigned int const slot = devices.get_slot(device_index);
+      if(slot + 1 != list->size()) {
+        (*list)[slot] = std::move(list->back());
+        devices.set_slot((*list)[slot].id, slot);
+      }
+      list->pop_back();
+    }
+    devices.remove(device_index);
+  }
+
+  std::vector<controller> *manager::get_device_list(vr::ETrackedDeviceClass device_class) {
+    /// Return the list devices of this class are kept in, or null if they're not kept in one
+    switch(device_class) {
+    case vr::TrackedDeviceClass_Controller:
+      return &controllers;
+    case vr::TrackedDeviceClass_Other:                                          // generic trackers, on this OpenVR version
+      return &trackers;
+    default:
+      return nullptr;
+    }
+  }
+
+  controller *manager::find_tracked_device(vr::TrackedDeviceIndex_t device_index) {
+    /// Return the controller or tracker entry for a device, or null if it doesn't have one
+    std::vector<controller> *const list = get_device_list(devices.get_class(device_index));
+    if(!list) {
+      return nullptr;
+    }
+    return &(*list)[devices.get_slot(device_index)];
+  }
+
+  void manager::load_controller_model(vr::TrackedDeviceIndex_t device_index) {
+    /// Attach a controller's render model from the cache, or request it in the background and attach it once it arrives
+    std::string const &render_model_name(get_device_properties(device_index).render_model_name);
+    if(render_model_name.empty()) {
+      return;
+    }
+    render_model_cache::draw_range const *mesh = model_cache.get(render_model_name);
+    if(!mesh) {
+      mesh = model_cache.load_from_disk(render_model_name);
+    }
+    if(mesh) {
+      if(controller *const this_controller = find_tracked_device(device_index)) {
+        this_controller->mesh = mesh;
+      }
+      return;
+    }
+    uint32_t const generation = devices.get_generation(device_index);
+    model_loader.load(render_model_name, [this, device_index, generation, render_model_name](vr::RenderModel_t *model, vr::RenderModel_TextureMap_t *texture){
+      render_model_cache::draw_range const *loaded_mesh = model_cache.add(render_model_name, *model, texture);
+      if(devices.get_generation(device_index) != generation) {
+        return;                                                                 // the index has been reused by a device activated while this loaded
+      }
+      if(controller *const this_controller = find_tracked_device(device_index)) { // null if it disconnected while loading
+        this_controller->model   = model;
+        this_controller->texture = texture;
+        this_controller->mesh    = loaded_mesh;
+      }
+    });
+  }
+
+  void manager::init_event_handlers() {
+    /// Fill the event dispatch table with VRStorm's own handlers
+    event_handlers[vr::VREvent_TrackedDeviceActivated  ] = &manager::handle_event_device_activated;   // when a new device is activated / connected
+    event_handlers[vr::VREvent_TrackedDeviceDeactivated] = &manager::handle_event_device_deactivated; // when a device is deactivated / disconnected
+    event_handlers[vr::VREvent_TrackedDeviceUpdated    ] = &manager::handle_event_device_updated;     // a device's properties have changed
+    event_handlers[vr::VREvent_TrackedDeviceRoleChanged] = &manager::handle_event_device_role_changed;
+    event_handlers[vr::VREvent_IpdChanged              ] = &manager::handle_event_ipd_changed;        // data is ipd
+    // input:
+    event_handlers[vr::VREvent_ButtonPress             ] = &manager::handle_event_button_press;       // data is controller
+    event_handlers[vr::VREvent_ButtonUnpress           ] = &manager::handle_event_button_unpress;     // data is controller
+    event_handlers[vr::VREvent_ButtonTouch             ] = &manager::handle_event_button_touch;       // data is controller
+    event_handlers[vr::VREvent_ButtonUntouch           ] = &manager::handle_event_button_untouch;     // data is controller
+    // known events we currently have no use for:
+    for(auto const event_type : {
+      vr::VREvent_None,
+      vr::VREvent_TrackedDeviceUserInteractionStarted,                          // when the headset wakes up
+      vr::VREvent_TrackedDeviceUserInteractionEnded,                            // when the headset goes to sleep
+      vr::VREvent_EnterStandbyMode,                                             // when the headset goes to sleep
+      vr::VREvent_LeaveStandbyMode,                                             // when the headset wakes up
+      vr::VREvent_MouseMove,                                                    // data is mouse
+      vr::VREvent_MouseButtonDown,                                              // data is mouse
+      vr::VREvent_MouseButtonUp,                                                // data is mouse
+      vr::VREvent_FocusEnter,                                                   // data is overlay
+      vr::VREvent_FocusLeave,                                                   // data is overlay
+      vr::VREvent_Scroll,                                                       // data is mouse
+      vr::VREvent_TouchPadMove,                                                 // data is mouse
+      vr::VREvent_InputFocusCaptured,                                           // data is process DEPRECATED
+      vr::VREvent_InputFocusReleased,                                           // data is process DEPRECATED
+      vr::VREvent_SceneFocusLost,                                               // data is process
+      vr::VREvent_SceneFocusGained,                                             // data is process
+      vr::VREvent_SceneApplicationChanged,                                      // data is process - The App actually drawing the scene changed (usually to or from the compositor)
+      vr::VREvent_SceneFocusChanged,                                            // data is process - New app got access to draw the scene
+      vr::VREvent_InputFocusChanged,                                            // data is process
+      vr::VREvent_SceneApplicationSecondaryRenderingStarted,                    // data is process
+      vr::VREvent_HideRenderModels,                                             // Sent to the scene application to request hiding render models temporarily
+      vr::VREvent_ShowRenderModels,                                             // Sent to the scene application to request restoring render model visibility
+      vr::VREvent_OverlayShown,
+      vr::VREvent_OverlayHidden,
+      vr::VREvent_DashboardActivated,                                           // user opens the dashboard, i.e. with hmd button
+      vr::VREvent_DashboardDeactivated,                                         // user closes the dashboard, i.e. with hmd button
+      vr::VREvent_DashboardThumbSelected,                                       // Sent to the overlay manager - data is overlay
+      vr::VREvent_DashboardRequested,                                           // Sent to the overlay manager - data is overlay
+      vr::VREvent_ResetDashboard,                                               // Send to the overlay manager
+      vr::VREvent_RenderToast,                                                  // Send to the dashboard to render a toast - data is the notification ID
+      vr::VREvent_ImageLoaded,                                                  // Sent to overlays when a SetOverlayRaw or SetOverlayFromFile call finishes loading
+      vr::VREvent_ShowKeyboard,                                                 // Sent to keyboard renderer in the dashboard to invoke it
+      vr::VREvent_HideKeyboard,                                                 // Sent to keyboard renderer in the dashboard to hide it
+      vr::VREvent_OverlayGamepadFocusGained,                                    // Sent to an overlay when IVROverlay::SetFocusOverlay is called on it
+      vr::VREvent_OverlayGamepadFocusLost,                                      // Send to an overlay when it previously had focus and IVROverlay::SetFocusOverlay is called on something else
+      vr::VREvent_OverlaySharedTextureChanged,
+      vr::VREvent_DashboardGuideButtonDown,
+      vr::VREvent_DashboardGuideButtonUp,
+      vr::VREvent_ScreenshotTriggered,                                          // Screenshot button combo was pressed, Dashboard should request a screenshot
+      vr::VREvent_ImageFailed,                                                  // Sent to overlays when a SetOverlayRaw or SetOverlayfromFail fails to load
+      vr::VREvent_RequestScreenshot,                                            // Sent by vrclient application to compositor to take a screenshot
+      vr::VREvent_ScreenshotTaken,                                              // Sent by compositor to the application that the screenshot has been taken
+      vr::VREvent_ScreenshotFailed,                                             // Sent by compositor to the application that the screenshot failed to be taken
+      vr::VREvent_SubmitScreenshotToDashboard,                                  // Sent by compositor to the dashboard that a completed screenshot was submitted
+      vr::VREvent_Notification_Shown,
+      vr::VREvent_Notification_Hidden,
+      vr::VREvent_Notification_BeginInteraction,
+      vr::VREvent_Notification_Destroyed,
+      vr::VREvent_Quit,                                                         // data is process
+      vr::VREvent_ProcessQuit,                                                  // data is process
+      vr::VREvent_QuitAborted_UserPrompt,                                       // data is process
+      vr::VREvent_QuitAcknowledged,                                             // data is process
+      vr::VREvent_DriverRequestedQuit,                                          // The driver has requested that SteamVR shut down
+      vr::VREvent_ChaperoneDataHasChanged,
+      vr::VREvent_ChaperoneUniverseHasChanged,
+      vr::VREvent_ChaperoneTempDataHasChanged,
+      vr::VREvent_ChaperoneSettingsHaveChanged,
+      vr::VREvent_SeatedZeroPoseReset,
+      vr::VREvent_AudioSettingsHaveChanged,
+      vr::VREvent_BackgroundSettingHasChanged,
+      vr::VREvent_CameraSettingsHaveChanged,
+      vr::VREvent_ReprojectionSettingHasChanged,
+      vr::VREvent_ModelSkinSettingsHaveChanged,
+      vr::VREvent_EnvironmentSettingsHaveChanged,
+      vr::VREvent_StatusUpdate,
+      vr::VREvent_MCImageUpdated,
+      vr::VREvent_FirmwareUpdateStarted,
+      vr::VREvent_FirmwareUpdateFinished,
+      vr::VREvent_KeyboardClosed,
+      vr::VREvent_KeyboardCharInput,
+      vr::VREvent_KeyboardDone,                                                 // Sent when DONE button clicked on keyboard
+      vr::VREvent_ApplicationTransitionStarted,
+      vr::VREvent_ApplicationTransitionAborted,
+      vr::VREvent_ApplicationTransitionNewAppStarted,
+      vr::VREvent_ApplicationListUpdated,
+      vr::VREvent_Compositor_MirrorWindowShown,
+      vr::VREvent_Compositor_MirrorWindowHidden,
+      vr::VREvent_Compositor_ChaperoneBoundsShown,
+      vr::VREvent_Compositor_ChaperoneBoundsHidden,
+      vr::VREvent_TrackedCamera_StartVideoStream,
+      vr::VREvent_TrackedCamera_StopVideoStream,
+      vr::VREvent_TrackedCamera_PauseVideoStream,
+      vr::VREvent_TrackedCamera_ResumeVideoStream,
+      vr::VREvent_PerformanceTest_EnableCapture,
+      vr::VREvent_PerformanceTest_DisableCapture,
+      vr::VREvent_PerformanceTest_FidelityLevel
+    }) {
+      event_handlers[event_type] = &manager::handle_event_ignore;
+    }
+  }
+
+  void manager::dispatch_event(vr::VREvent_t const &event) {
+    /// Call VRStorm's handler and any application binding for this event type
+    if(event.eventType < max_event_type) {
+      event_handler const handler = event_handlers[event.eventType];
+      auto const &binding = event_bindings[event.eventType];
+      if(handler) {
+        (this->*handler)(event);
+      }
+      if(binding) {
+        binding(event);
+      }
+      if(handler || binding) {
+        return;
+      }
+    }
+    if(event.eventType >= vr::VREvent_VendorSpecific_Reserved_Start &&         // vendors are free to expose private events in this reserved region
+       event.eventType <= vr::VREvent_VendorSpecific_Reserved_End) {
+      log(logger::level::debug) << "VRStorm: DEBUG: Received a vendor specific event on device " << event.trackedDeviceIndex << ", type " << event.eventType;
+    } else {
+      static logger::rate_limit unknown_event_limit;
+      log(logger::level::warning, unknown_event_limit) << "VRStorm: WARNING: Received an unknown event on device " << event.trackedDeviceIndex << ", type " << event.eventType;
+    }
+  }
+
+  void manager::dispatch_button_event(vr::VREvent_t const &event, input::controller::actiontype action) {
+    /// Pass a button event to the input controller, looking the hand up from the cached device roles
+    unsigned int const button = event.data.controller.button;
+    input::controller::hand_type const hand = devices.get_hand(event.trackedDeviceIndex); // unknown if out of range
+    if(hand == input::controller::hand_type::UNKNOWN) {
+      static logger::rate_limit unknown_controller_limit;
+      log(logger::level::warning, unknown_controller_limit) << "VRStorm: WARNING: button " << button << " " << input::controller::get_actiontype_name(action) << " on unknown controller " << event.trackedDeviceIndex << "!";
+      return;
+    }
+    if(log.enabled(logger::level::debug)) {                                     // avoid building the message on every button event unless it'll be logged
+      log(logger::level::debug) << "VRStorm: DEBUG: button " << button << " " << input::controller::get_actiontype_name(action) << " on " << input::controller::get_handtype_name(hand) << " controller";
+    }
+    if(action == input::controller::actiontype::PRESS && input_controller.get_id(hand) != event.trackedDeviceIndex) {
+      // the handedness of this report does not agree with the hand assignment - move just this controller
+      input_controller.update_device(event.trackedDeviceIndex);
+    }
+    input_controller.execute_button(hand, button, action);
+  }
+
+  void manager::handle_event_ignore(vr::VREvent_t const &event [[maybe_unused]]) {
+    /// Handler for known events that need no action
+  }
+  void manager::handle_event_device_activated(vr::VREvent_t const &event) {
+    /// Handler for a new device being activated / connected
+    if(event.trackedDeviceIndex >= vr::k_unMaxTrackedDeviceCount) {
+      static logger::rate_limit invalid_device_limit;
+      log(logger::level::warning, invalid_device_limit) << "VRStorm: WARNING: ignoring activation of invalid device id " << event.trackedDeviceIndex;
+      return;
+    }
+    log(logger::level::debug) << "VRStorm: DEBUG: controller id " << event.trackedDeviceIndex << " has been activated.";
+    refresh_device_properties(event.trackedDeviceIndex);
+    add_tracked_device(event.trackedDeviceIndex, device_properties[event.trackedDeviceIndex].device_class);
+    input_controller.add_device(event.trackedDeviceIndex);
+    if(find_tracked_device(event.trackedDeviceIndex)) {
+      load_controller_model(event.trackedDeviceIndex);
+    }
+  }
+  void manager::handle_event_device_deactivated(vr::VREvent_t const &event) {
+    /// Handler for a device being deactivated / disconnected
+    log(logger::level::debug) << "VRStorm: DEBUG: controller id " << event.trackedDeviceIndex << " has been deactivated.";
+    remove_tracked_device(event.trackedDeviceIndex);
+    invalidate_device_properties(event.trackedDeviceIndex);
+    input_controller.remove_device(event.trackedDeviceIndex);
+  }
+  void manager::handle_event_device_updated(vr::VREvent_t const &event) {
+    /// Handler for a device's properties changing
+    refresh_device_properties(event.trackedDeviceIndex);
+    input_controller.update_device(event.trackedDeviceIndex);                   // its role may have changed with them
+    if(event.trackedDeviceIndex == vr::k_unTrackedDeviceIndex_Hmd) {
+      update_ipd(device_properties[vr::k_unTrackedDeviceIndex_Hmd].user_ipd);
+      projection_nearplane = 0.0f;                                              // the display may have changed, so recompute projections
+      hidden_area.update(hmd_handle);
+    }
+  }
+  void manager::handle_event_device_role_changed(vr::VREvent_t const &event [[maybe_unused]]) {
+    /// Handler for controller roles being reassigned
+    refresh_device_roles();
+  }
+  void manager::handle_event_ipd_changed(vr::VREvent_t const &event) {
+    /// Handler for the user changing the inter-pupillary distance
+    device_properties[vr::k_unTrackedDeviceIndex_Hmd].user_ipd = event.data.ipd.ipdMeters;
+    update_ipd(event.data.ipd.ipdMeters);
+    update_eye_matrices();                                                      // events follow the pose update, so don't wait for the next frame's
+  }
+  void manager::handle_event_button_press(vr::VREvent_t const &event) {
+    /// Handler for a controller button press
+    dispatch_button_event(event, input::controller::actiontype::PRESS);
+  }
+  void manager::handle_event_button_unpress(vr::VREvent_t const &event) {
+    /// Handler for a controller button release
+    dispatch_button_event(event, input::controller::actiontype::RELEASE);
+  }
+  void manager::handle_event_button_touch(vr::VREvent_t const &event) {
+    /// Handler for a controller button touch
+    dispatch_button_event(event, input::controller::actiontype::TOUCH);
+  }
+  void manager::handle_event_button_untouch(vr::VREvent_t const &event) {
+    /// Handler for a controller button touch ending
+    dispatch_button_event(event, input::controller::actiontype::UNTOUCH);
+  }
+#endif // VRSTORM_DISABLED
+
+void manager::start_frame_thread() {
+  /// Start a dedicated thread to wait on the compositor, dispatch events and publish pose snapshots every frame
+  // NOTE: input callbacks will be called from the frame thread while it is running
+  #ifndef VRSTORM_DISABLED
+    if(!enabled || frame_thread_running.load(std::memory_order_relaxed)) {
+      return;
+    }
+    log(logger::level::info) << "VRStorm: Starting frame thread.";
+    frame_thread_running.store(true, std::memory_order_release);
+    frame_thread = std::thread(&manager::frame_thread_loop, this);
   #endif // VRSTORM_DISABLED
 }
+void manager::stop_frame_thread() {
+  /// Stop the frame thread if it's running, and wait for it to finish its current frame
+  frame_thread_running.store(false, std::memory_order_release);
+  if(frame_thread.joinable()) {
+    frame_thread.join();
+    log(logger::level::info) << "VRStorm: Frame thread stopped.";
+  }
+}
+bool manager::get_frame_thread_running() const {
+  /// Return whether the frame thread is currently responsible for updates
+  return frame_thread_running.load(std::memory_order_relaxed);
+}
+
+pose_snapshot const &manager::get_pose_snapshot(unsigned int reader) {
+  /// Return the latest published poses, wait-free - each reading thread must use its own reader number
+  #ifndef NDEBUG
+    // boundary safety check
+    if(reader >= max_pose_readers) {
+      log(logger::level::error) << "VRStorm: ERROR: attempting to read pose snapshot reader " << reader << " when max is " << max_pose_readers - 1;
+      return pose_snapshots[0].get_front();
+    }
+  #endif // NDEBUG
+  return pose_snapshots[reader].get_front();
+}
+
+#ifndef VRSTORM_DISABLED
+  void manager::frame_thread_loop() {
+    /// Body of the frame thread, runs until stopped
+    uint64_t frame = 0;
+    while(frame_thread_running.load(std::memory_order_acquire)) {
+      if(backend == backend_type::REPLAY) {
+        stub.advance();
+      }
+      std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> tracked_device_poses;
+      auto const time_start(std::chrono::steady_clock::now());
+      compositor->WaitGetPoses(tracked_device_poses.data(), vr::k_unMaxTrackedDeviceCount, nullptr, 0);
+      current_frame_timing.wait_ms += milliseconds_since(time_start);
+      recorder.record_frame(tracked_device_poses);
+      auto const time_poses(std::chrono::steady_clock::now());
+      update_poses(tracked_device_poses);
+      current_frame_timing.update_ms += milliseconds_since(time_poses);
+      publish_pose_snapshot(++frame);                     // publish before dispatching events, so readers get the poses as early as possible
+      update_events();
+      record_frame_timing();
+    }
+  }
+
+  void manager::publish_pose_snapshot(uint64_t frame) {
+    /// Copy this frame's poses into every reader's triple buffer
+    pose_snapshot &snapshot = pose_snapshots[0].get_back();                     // convert once into the first reader's buffer
+    snapshot.frame = frame;
+    snapshot.hmd_position = hmd_position;
+    snapshot.controller_mask = devices.get_class_mask(vr::TrackedDeviceClass_Controller);
+    snapshot.tracker_mask    = devices.get_class_mask(vr::TrackedDeviceClass_Other);
+    for(unsigned int i = 0; i != vr::k_unMaxTrackedDeviceCount; ++i) {
+      snapshot.device_valid[i] = tracked_poses.get_valid(i);
+      if(snapshot.device_valid[i]) {
+        tracked_poses.get_mat4(i, snapshot.device_positions[i]);
+      }
+    }
+    for(unsigned int reader = 1; reader != max_pose_readers; ++reader) {
+      pose_snapshots[reader].get_back() = snapshot;                             // then copy to all the others
+    }
+    for(auto &it : pose_snapshots) {
+      it.publish();
+    }
+  }
+#endif // VRSTORM_DISABLED
 
 vec2<GLsizei> const &manager::get_render_target_size() const {
   /// Return the size of the render target for this VR system
   return render_target_size;
 }
+vec2<GLsizei> const &manager::get_scaled_render_target_size() {
+  /// Return the area of the render target to render this frame into, latching it for this frame's submits - call once per frame before rendering
+  float const scale = resolution.get_scale();
+  scaled_render_target_size.x = std::max(1, static_cast<GLsizei>(std::lround(static_cast<float>(render_target_size.x) * scale)));
+  scaled_render_target_size.y = std::max(1, static_cast<GLsizei>(std::lround(static_cast<float>(render_target_size.y) * scale)));
+  #ifndef VRSTORM_DISABLED
+    render_target_bounds.uMax = render_target_size.x == 0 ? 1.0f : static_cast<float>(scaled_render_target_size.x) / static_cast<float>(render_target_size.x);
+    render_target_bounds.vMax = render_target_size.y == 0 ? 1.0f : static_cast<float>(scaled_render_target_size.y) / static_cast<float>(render_target_size.y);
+  #endif // VRSTORM_DISABLED
+  return scaled_render_target_size;
+}
 
 #ifndef VRSTORM_DISABLED
   std::string manager::get_tracked_device_string(vr::TrackedDeviceIndex_t device_index,
@@ -904,26 +1218,232 @@ vec2<GLsizei> const &manager::get_render_target_size() const {
     if(!hmd_handle) {
       return "";
     }
-    uint32_t buffer_len = hmd_handle->GetStringTrackedDeviceProperty(device_index, prop, NULL, 0, vr_error);
+    std::array<char, 256> short_buffer;                                         // most properties fit, so try without querying the length first
+    uint32_t const buffer_len = hmd_handle->GetStringTrackedDeviceProperty(device_index, prop, short_buffer.data(), static_cast<uint32_t>(short_buffer.size()), vr_error);
     if(buffer_len == 0) {
       return "";
     }
-    std::string buffer(buffer_len, '\0');
-    buffer_len = hmd_handle->GetStringTrackedDeviceProperty(device_index, prop, &buffer[0], buffer_len, vr_error);
+    if(buffer_len <= short_buffer.size()) {
+      return std::string(short_buffer.data(), buffer_len - 1);                  // length includes the null terminator
+    }
+    std::string buffer(buffer_len, '\0');                                       // too long, so fetch it again at the full length
+    hmd_handle->GetStringTrackedDeviceProperty(device_index, prop, &buffer[0], buffer_len, vr_error);
+    buffer.resize(buffer_len - 1);
     return buffer;
   }
 
+  tracked_device_properties const &manager::get_device_properties(vr::TrackedDeviceIndex_t device_index) {
+    /// Return the cached properties of a device, querying them first if they aren't cached yet
+    #ifndef NDEBUG
+      // boundary safety check
+      if(device_index >= vr::k_unMaxTrackedDeviceCount) {
+        log(logger::level::error) << "VRStorm: ERROR: attempting to get properties of tracked device " << device_index << " when max is " << vr::k_unMaxTrackedDeviceCount - 1;
+        return device_properties[0];
+      }
+    #endif // NDEBUG
+    if(!device_properties[device_index].cached) {
+      refresh_device_properties(device_index);
+    }
+    return device_properties[device_index];
+  }
+  device_registry const &manager::get_devices() const {
+    /// Return the registry of connected devices, for looking up a device's class, role, hand or list slot - like controllers, only from the thread running update_events()
+    return devices;
+  }
+
+  render_model_cache &manager::get_render_models() {
+    /// Return the shared render model buffers, for drawing controllers' meshes
+    return model_cache;
+  }
+
+  void manager::bind_event(vr::EVREventType event_type, std::function<void(vr::VREvent_t const&)> func) {
+    /// Bind an application callback to an event type, called after any handling VRStorm does itself
+    if(static_cast<unsigned int>(event_type) >= max_event_type) {
+      log(logger::level::error) << "VRStorm: ERROR: attempting to bind event type " << static_cast<unsigned int>(event_type) << " when max is " << max_event_type - 1;
+      return;
+    }
+    event_bindings[event_type] = func;
+  }
+  void manager::unbind_event(vr::EVREventType event_type) {
+    /// Remove an application callback from an event type
+    if(static_cast<unsigned int>(event_type) >= max_event_type) {
+      return;
+    }
+    event_bindings[event_type] = nullptr;
+  }
+
+  float manager::get_seconds_to_photons() const {
+    /// Predict the time from now until the next frame's photons leave the display
+    // as per https://github.com/ValveSoftware/openvr/wiki/IVRSystem::GetDeviceToAbsoluteTrackingPose
+    float time_since_vsync = 0.0f;
+    hmd_handle->GetTimeSinceLastVsync(&time_since_vsync, nullptr);
+    return frame_duration - time_since_vsync + vsync_to_photon_time;
+  }
+
   void manager::setup_render_perspective_one_eye(vr::EVREye eye) {
-    /// Set up the render perspective for the specified openvr eye
-    // Order: Model * View * Eye^-1 * Projection.
+    /// Set up the fixed-function render perspective for the specified openvr eye - not while the frame thread runs, as it rewrites the eye matrices
+    if(nearplane != projection_nearplane || farplane != projection_farplane) {
+      update_eye_matrices();                                                    // planes changed since the last pose update
+    }
+    eye_matrices const &matrices = eye_camera[static_cast<unsigned int>(eye)];
     glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(mat4f::from_row_major_array(*hmd_handle->GetProjectionMatrix(eye, nearplane, farplane, vr::API_OpenGL).m)); // projection matrix
+    glLoadMatrixf(matrices.projection);                                         // cached projection matrix
 
     glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glMultMatrixf(eye_to_head_transform[static_cast<unsigned int>(eye)]);       // cached eye position matrix
-    glMultMatrixf(hmd_position);                                                // head position matrix
+    glLoadMatrixf(matrices.view);                                               // cached eye and head position matrix
   };
+
+  std::vector<manager::init_phase_timing> const &manager::get_init_timings() const {
+    /// Return how long each phase of the last init() took, for keeping cold startup short
+    return init_timings;
+  }
+  frame_timing_stats manager::get_frame_timing_stats() const {
+    /// Summarise recent frame timings - safe to call from any thread
+    return frame_timings.get_stats();
+  }
+  frame_timing_ring const &manager::get_frame_timings() const {
+    /// Return the ring of recent frame timings, for reading individual samples from any thread
+    return frame_timings;
+  }
+
+  vr::VRTextureBounds_t const &manager::get_render_target_bounds() const {
+    /// Return the texture bounds matching the last scaled render target size, as used when submitting
+    return render_target_bounds;
+  }
+
+  void manager::draw_hidden_area_mask(vr::EVREye eye) {
+    /// Write depth over the parts of this eye the lenses can't show, so the main pass skips them - call after clearing, with the eye's viewport set
+    hidden_area.draw(eye);
+  }
+
+  eye_matrices const &manager::get_eye_matrices(vr::EVREye eye) const {
+    /// Return the view, projection and view-projection matrices for an eye, as of the last pose update - not while the frame thread runs, as it rewrites them
+    return eye_camera[static_cast<unsigned int>(eye)];
+  }
+
+  void manager::write_eye_matrices(GLuint uniform_buffer, GLintptr offset) const {
+    /// Copy both eyes' matrices, left then right, into a uniform buffer at the given offset, without touching fixed-function state
+    glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(eye_camera), eye_camera.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  void manager::bind_late_latch_uniforms(GLuint binding) {
+    /// Move to the next frame's region of the late-latch uniform buffer, fill it with the current eye matrices and bind it - call before issuing draws
+    if(!late_latch_buffer) {
+      init_late_latch_buffer();
+    }
+    late_latch_region = (late_latch_region + 1) % late_latch_regions;           // don't touch regions the GPU may still be reading for earlier frames
+    write_late_latch_region();
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, late_latch_buffer, static_cast<GLintptr>(late_latch_region * late_latch_region_size), sizeof(eye_camera));
+  }
+
+  void manager::late_latch() {
+    /// Re-predict poses just before submitting, and update the bound late-latch uniforms that already-issued draws will read
+    // NOTE: does nothing while the frame thread is running, as it owns the poses then
+    // NOTE: this OpenVR version's Submit() takes no pose, so the compositor still reprojects against the pose from WaitGetPoses, not this one
+    if(!enabled || frame_thread_running.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> tracked_device_poses;
+    hmd_handle->GetDeviceToAbsoluteTrackingPose(tracking_space, get_seconds_to_photons(), tracked_device_poses.data(), vr::k_unMaxTrackedDeviceCount);
+    recorder.record_render_poses(tracked_device_poses);                         // these replace any from wait_for_frame() as the poses rendered with
+    update_poses(tracked_device_poses);
+    if(late_latch_mapping) {
+      write_late_latch_region();                                                // without a persistent mapping, the draws already have their matrices
+    }
+  }
+
+  bool manager::start_recording(std::string const &path, unsigned int capacity) {
+    /// Start recording the poses, controller states and events read each frame into a session log holding the most recent frames
+    // NOTE: the recorder is written by whichever thread updates, so this can't be called while the frame thread is running
+    if(!enabled) {
+      return false;
+    }
+    if(frame_thread_running.load(std::memory_order_relaxed)) {
+      log(logger::level::warning) << "VRStorm: WARNING: Can't start recording while the frame thread is running.";
+      return false;
+    }
+    session_log_devices recorded_devices;
+    recorded_devices.display_frequency = 1.0f / frame_duration;
+    recorded_devices.vsync_to_photon_time = vsync_to_photon_time;
+    recorded_devices.user_ipd = ipd;
+    for(vr::TrackedDeviceIndex_t i = 0; i != vr::k_unMaxTrackedDeviceCount; ++i) {
+      recorded_devices.device_classes[i] = hmd_handle->GetTrackedDeviceClass(i);
+      recorded_devices.roles[i] = hmd_handle->GetControllerRoleForTrackedDeviceIndex(i);
+    }
+    if(!recorder.start(path, recorded_devices, capacity)) {
+      log(logger::level::error) << "VRStorm: Unable to create session log \"" << path << "\" for recording.";
+      return false;
+    }
+    log(logger::level::info) << "VRStorm: Recording the last " << capacity << " frames to session log \"" << path << "\".";
+    return true;
+  }
+  void manager::stop_recording() {
+    /// Finish and close the session log, if recording
+    // NOTE: as with starting, this can't be called while the frame thread is running
+    if(!recorder.get_recording()) {
+      return;
+    }
+    if(frame_thread_running.load(std::memory_order_relaxed)) {
+      log(logger::level::warning) << "VRStorm: WARNING: Can't stop recording while the frame thread is running.";
+      return;
+    }
+    recorder.stop();
+    log(logger::level::info) << "VRStorm: Session log recording stopped.";
+  }
+  bool manager::get_recording() const {
+    /// Return whether a session log is being recorded
+    return recorder.get_recording();
+  }
+
+  void manager::init_late_latch_buffer() {
+    /// Create the late-latch uniform buffer, persistently mapped if supported
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max(alignment, 1);
+    late_latch_region_size = (static_cast<GLsizeiptr>(sizeof(eye_camera)) + alignment - 1) / alignment * alignment;
+    GLsizeiptr const buffer_size = late_latch_region_size * late_latch_regions;
+    glGenBuffers(1, &late_latch_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, late_latch_buffer);
+    if(GLEW_ARB_buffer_storage) {
+      GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT; // coherent, so writes reach the GPU without any further calls
+      glBufferStorage(GL_UNIFORM_BUFFER, buffer_size, nullptr, flags);
+      late_latch_mapping = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, buffer_size, flags));
+    }
+    if(!late_latch_mapping) {
+      log(logger::level::info) << "VRStorm: Persistently mapped buffers are unavailable, late-latched poses will not reach draws already issued";
+      glBufferData(GL_UNIFORM_BUFFER, buffer_size, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  void manager::delete_late_latch_buffer() {
+    /// Unmap and delete the late-latch uniform buffer, if any
+    if(!late_latch_buffer) {
+      return;
+    }
+    if(late_latch_mapping) {
+      glBindBuffer(GL_UNIFORM_BUFFER, late_latch_buffer);
+      glUnmapBuffer(GL_UNIFORM_BUFFER);
+      glBindBuffer(GL_UNIFORM_BUFFER, 0);
+      late_latch_mapping = nullptr;
+    }
+    glDeleteBuffers(1, &late_latch_buffer);
+    late_latch_buffer = 0;
+  }
+
+  void manager::write_late_latch_region() {
+    /// Copy the current eye matrices into this frame's region of the late-latch buffer
+    GLintptr const offset = static_cast<GLintptr>(late_latch_region * late_latch_region_size);
+    if(late_latch_mapping) {
+      std::memcpy(late_latch_mapping + offset, eye_camera.data(), sizeof(eye_camera));
+    } else {
+      glBindBuffer(GL_UNIFORM_BUFFER, late_latch_buffer);
+      glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(eye_camera), eye_camera.data());
+      glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+  }
 #endif // VRSTORM_DISABLED
 
 void manager::setup_render_perspective_left() {
@@ -947,7 +1467,7 @@ void manager::submit_frame_left(GLuint buffer
   /// Send a frame to the compositor for the left eye
   #ifndef VRSTORM_DISABLED
     vr::Texture_t texture_container{reinterpret_cast<void*>(buffer), vr::API_OpenGL, vr::ColorSpace_Gamma};
-    compositor->Submit(vr::Eye_Left, &texture_container, nullptr, vr::Submit_Default);
+    compositor->Submit(vr::Eye_Left, &texture_container, &render_target_bounds, vr::Submit_Default);
   #endif // VRSTORM_DISABLED
 }
 void manager::submit_frame_right(GLuint buffer
@@ -958,8 +1478,109 @@ void manager::submit_frame_right(GLuint buffer
   /// Send a frame to the compositor for the right eye
   #ifndef VRSTORM_DISABLED
     vr::Texture_t texture_container{reinterpret_cast<void*>(buffer), vr::API_OpenGL, vr::ColorSpace_Gamma};
-    compositor->Submit(vr::Eye_Right, &texture_container, nullptr, vr::Submit_Default);
+    compositor->Submit(vr::Eye_Right, &texture_container, &render_target_bounds, vr::Submit_Default);
+  #endif // VRSTORM_DISABLED
+}
+void manager::end_frame() {
+  /// Hand the submitted frame to the compositor now, rather than whenever the driver next flushes - call after submitting both eyes
+  #ifndef VRSTORM_DISABLED
+    if(!enabled) {
+      return;
+    }
+    GLsync fence = end_frame_fence ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    glFlush();                                                                  // start the GPU on everything we've issued, including the fence
+    compositor->PostPresentHandoff();                                           // let the compositor start work without waiting for our next WaitGetPoses
+    if(fence) {
+      auto const time_start(std::chrono::steady_clock::now());
+      GLenum const result = glClientWaitSync(fence, 0, static_cast<GLuint64>(end_frame_fence_timeout_ms * 1000000.0f));
+      float const fence_wait_ms = milliseconds_since(time_start);
+      glDeleteSync(fence);
+      last_fence_wait_ms.store(fence_wait_ms, std::memory_order_relaxed);
+      if(result == GL_TIMEOUT_EXPIRED) {
+        log(logger::level::debug) << "VRStorm: DEBUG: end of frame fence timed out after " << fence_wait_ms << "ms";
+      }
+    }
   #endif // VRSTORM_DISABLED
 }
 
+void manager::submit_frame_stereo(GLuint buffer,
+                                  stereo_layout_type layout
+                                  #ifdef VRSTORM_DISABLED
+                                    [[maybe_unused]]
+                                  #endif // VRSTORM_DISABLED
+                                  ) {
+  /// Send a frame to the compositor for both eyes from a single texture
+  #ifndef VRSTORM_DISABLED
+    switch(layout) {
+    case stereo_layout_type::SIDE_BY_SIDE:
+      {
+        // each eye's half is scaled from its own left edge
+        vr::VRTextureBounds_t const bounds_left{ 0.0f, 0.0f,        render_target_bounds.uMax * 0.5f, render_target_bounds.vMax};
+        vr::VRTextureBounds_t const bounds_right{0.5f, 0.0f, 0.5f + render_target_bounds.uMax * 0.5f, render_target_bounds.vMax};
+        vr::Texture_t texture_container{reinterpret_cast<void*>(buffer), vr::API_OpenGL, vr::ColorSpace_Gamma};
+        compositor->Submit(vr::Eye_Left,  &texture_container, &bounds_left,  vr::Submit_Default);
+        compositor->Submit(vr::Eye_Right, &texture_container, &bounds_right, vr::Submit_Default);
+      }
+      break;
+    case stereo_layout_type::ARRAY:
+      {
+        // this runtime has no array texture submit flag, so submit a 2D view of each layer - views share storage, so nothing is copied
+        update_array_texture_views(buffer);
+        vr::Texture_t texture_container_left{ reinterpret_cast<void*>(static_cast<uintptr_t>(array_texture_views[vr::Eye_Left ])), vr::API_OpenGL, vr::ColorSpace_Gamma};
+        vr::Texture_t texture_container_right{reinterpret_cast<void*>(static_cast<uintptr_t>(array_texture_views[vr::Eye_Right])), vr::API_OpenGL, vr::ColorSpace_Gamma};
+        compositor->Submit(vr::Eye_Left,  &texture_container_left,  &render_target_bounds, vr::Submit_Default);
+        compositor->Submit(vr::Eye_Right, &texture_container_right, &render_target_bounds, vr::Submit_Default);
+      }
+      break;
+    }
+  #endif // VRSTORM_DISABLED
+}
+
+#ifndef VRSTORM_DISABLED
+  void manager::update_array_texture_views(GLuint array_texture) {
+    /// Create a 2D texture view of each eye's layer of an array texture, only when its name, size or format changes
+    // NOTE: glTextureView needs immutable storage, so the array texture must be allocated with glTexStorage3D
+    GLint width = 0;
+    GLint height = 0;
+    GLint internal_format = 0;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array_texture);                          // a name can be deleted and reused with different storage, so check that too
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_WIDTH,           &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_HEIGHT,          &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    if(array_texture == array_texture_source &&
+       width == array_texture_size.x &&
+       height == array_texture_size.y &&
+       internal_format == array_texture_format) {
+      glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+      return;
+    }
+    GLint immutable = GL_FALSE;
+    glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    delete_array_texture_views();
+    if(!immutable) {
+      log(logger::level::error) << "VRStorm: Array texture " << array_texture << " has mutable storage, allocate it with glTexStorage3D to submit it";
+      return;                                                                   // the views stay zero, so the compositor is handed nothing rather than a GL error
+    }
+    glGenTextures(static_cast<GLsizei>(array_texture_views.size()), array_texture_views.data());
+    for(unsigned int eye = 0; eye != array_texture_views.size(); ++eye) {
+      glTextureView(array_texture_views[eye], GL_TEXTURE_2D, array_texture, static_cast<GLenum>(internal_format), 0, 1, eye, 1);
+    }
+    array_texture_source = array_texture;
+    array_texture_size = vec2<GLint>(width, height);
+    array_texture_format = internal_format;
+  }
+  void manager::delete_array_texture_views() {
+    /// Delete the per-eye array texture views, if any
+    if(array_texture_source == 0) {
+      return;
+    }
+    glDeleteTextures(static_cast<GLsizei>(array_texture_views.size()), array_texture_views.data());
+    array_texture_views.fill(0);
+    array_texture_source = 0;
+    array_texture_size = vec2<GLint>(0, 0);
+    array_texture_format = 0;
+  }
+#endif // VRSTORM_DISABLED
+
 }
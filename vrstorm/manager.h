@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include <GL/glew.h>
@@ -13,7 +16,23 @@
 #include "platform_defines.h"
 #include "vectorstorm/vector/vector2.h"
 #include "vectorstorm/matrix/matrix4.h"
+#include "adaptive_resolution.h"
 #include "controller.h"
+#include "device_registry.h"
+#include "eye_matrices.h"
+#include "frame_timing.h"
+#include "hidden_area_mask.h"
+#include "logger.h"
+#include "openvr_symbols.h"
+#include "pose_snapshot.h"
+#include "pose_table.h"
+#include "render_model_cache.h"
+#include "render_model_loader.h"
+#include "rigid_pose.h"
+#include "session_log.h"
+#include "stub_runtime.h"
+#include "tracked_device_properties.h"
+#include "triple_buffer.h"
 
 #ifdef VRSTORM_DISABLED
   #define VRSTORM_CONST_IF_DISABLED __attribute__((__const__));
@@ -26,27 +45,161 @@ namespace vrstorm {
 class manager {
   friend class input::controller;
 
+public:
+  logger log;                                                                   // declared first so it outlives everything that logs, use log.set_level() to change verbosity
+
+  struct init_phase_timing {
+    char const *name;
+    float milliseconds;
+  };
+
+private:
   void *lib = nullptr;
 
   #ifndef VRSTORM_DISABLED
-    std::unordered_map<std::string, vr::RenderModel_t*> models;
+    openvr_symbols symbols;                                                     // resolved from lib once at startup
+    bool diagnostics_pending = false;                                           // startup details that rendering doesn't depend on are still to be logged
+    render_model_loader model_loader{log};
+    render_model_cache model_cache{log};
 
     vr::IVRSystem     *hmd_handle = nullptr;
     vr::IVRCompositor *compositor = nullptr;
 
+    std::array<tracked_device_properties, vr::k_unMaxTrackedDeviceCount> device_properties; // cached per-device properties, indexed by tracked device id
+
     std::array<mat4f, 2> eye_to_head_transform;
+    std::array<eye_matrices, 2> eye_camera;                                     // per-eye view and cached projection, refreshed with the poses
+    float projection_nearplane = 0.0f;                                          // planes the cached projections were computed with, zero to force recomputing
+    float projection_farplane  = 0.0f;
+
+    hidden_area_mask hidden_area{log};
+
+    static unsigned int constexpr late_latch_regions = 3;                       // one per frame that may be in flight
+    GLuint late_latch_buffer = 0;
+    uint8_t *late_latch_mapping = nullptr;                                      // persistently mapped, null if unsupported
+    GLsizeiptr late_latch_region_size = 0;                                      // eye matrices rounded up to the uniform offset alignment
+    unsigned int late_latch_region = 0;                                         // region in use for this frame
+
+    void init_late_latch_buffer();
+    void delete_late_latch_buffer();
+    void write_late_latch_region();
+
+    std::vector<init_phase_timing> init_timings;                                // how long each phase of the last init() took
+
+    frame_timing_sample current_frame_timing;                                   // accumulated until the frame is recorded
+    frame_timing_ring frame_timings;
+    std::atomic<float> last_fence_wait_ms{0.0f};                                // from end_frame() on the render thread, until recorded
 
     float ipd = 0.0f;
+
+    vr::ETrackingUniverseOrigin tracking_space = vr::TrackingUniverseStanding;  // cached compositor tracking space, for pose prediction
+    float frame_duration = 0.0f;                                                // seconds per frame at the display frequency
+    float vsync_to_photon_time = 0.0f;                                          // seconds from vsync until photons are emitted
+
+    void log_diagnostics();
+    void update_poses(std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> const &tracked_device_poses);
+    void update_ipd(float new_ipd);
+    void record_frame_timing();
+    void update_projection();
+    void update_eye_matrices();
+    void refresh_device_properties(vr::TrackedDeviceIndex_t device_index);
+    void refresh_device_roles();
+    void invalidate_device_properties(vr::TrackedDeviceIndex_t device_index);
+    void add_tracked_device(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceClass device_class);
+    void remove_tracked_device(vr::TrackedDeviceIndex_t device_index);
+    std::vector<controller> *get_device_list(vr::ETrackedDeviceClass device_class) __attribute__((__pure__));
+    controller *find_tracked_device(vr::TrackedDeviceIndex_t device_index) __attribute__((__pure__));
+    void load_controller_model(vr::TrackedDeviceIndex_t device_index);
+
+    GLuint array_texture_source = 0;                                            // array texture the eye views below were made from
+    vec2<GLint> array_texture_size;                                             // and its size and internal format when they were made
+    GLint array_texture_format = 0;
+    std::array<GLuint, 2> array_texture_views{};                                // per-eye 2D views sharing the array texture's storage
+
+    void update_array_texture_views(GLuint array_texture);
+    void delete_array_texture_views();
   #endif // VRSTORM_DISABLED
+  void update_events() VRSTORM_CONST_IF_DISABLED;
 
   vec2<GLsizei> render_target_size;
+  vec2<GLsizei> scaled_render_target_size;                                      // latched by get_scaled_render_target_size() for this frame
+  #ifndef VRSTORM_DISABLED
+    vr::VRTextureBounds_t render_target_bounds{0.0f, 0.0f, 1.0f, 1.0f};         // the matching part of the render target to submit
+  #endif // VRSTORM_DISABLED
 
 public:
+  // limits
+  static unsigned int constexpr max_pose_readers = 4;                           // number of threads that can independently read pose snapshots
+  static unsigned int constexpr max_event_type = 2048;                          // event types below this are dispatched through tables, above are vendor specific
+
+private:
+  std::thread frame_thread;                                                     // optional thread that paces frames and publishes poses
+  std::atomic<bool> frame_thread_running{false};
+  std::array<triple_buffer<pose_snapshot>, max_pose_readers> pose_snapshots;    // one wait-free channel per reading thread
+
   #ifndef VRSTORM_DISABLED
-    std::vector<controller> controllers;
+    void frame_thread_loop();
+    void publish_pose_snapshot(uint64_t frame);
+
+    using event_handler = void (manager::*)(vr::VREvent_t const&);
+    std::array<event_handler, max_event_type> event_handlers{};                 // VRStorm's own handler for each event type
+    std::array<std::function<void(vr::VREvent_t const&)>, max_event_type> event_bindings; // application callbacks for each event type
+    device_registry devices;                                                    // class, role, hand and list slot of each connected device, by device id
+
+    void init_event_handlers();
+    void dispatch_event(vr::VREvent_t const &event);
+    void dispatch_button_event(vr::VREvent_t const &event, input::controller::actiontype action);
+
+    void handle_event_ignore(             vr::VREvent_t const &event);
+    void handle_event_device_activated(   vr::VREvent_t const &event);
+    void handle_event_device_deactivated( vr::VREvent_t const &event);
+    void handle_event_device_updated(     vr::VREvent_t const &event);
+    void handle_event_device_role_changed(vr::VREvent_t const &event);
+    void handle_event_ipd_changed(        vr::VREvent_t const &event);
+    void handle_event_button_press(       vr::VREvent_t const &event);
+    void handle_event_button_unpress(     vr::VREvent_t const &event);
+    void handle_event_button_touch(       vr::VREvent_t const &event);
+    void handle_event_button_untouch(     vr::VREvent_t const &event);
+  #endif // VRSTORM_DISABLED
+
+public:
+  enum class stereo_layout_type : char {
+    SIDE_BY_SIDE,                                                               // one 2D texture, left eye in the left half and right eye in the right half
+    ARRAY                                                                       // one 2D array texture allocated with glTexStorage3D, left eye in layer 0 and right eye in layer 1
+  };
+
+  enum class backend_type : char {
+    OPENVR,                                                                     // the OpenVR runtime, loaded from its dynamic library
+    STUB,                                                                       // the built-in stub runtime, with synthetic devices and no headset
+    REPLAY                                                                      // the stub runtime playing back a recorded session from replay_path
+  };
+
+  enum class pose_mode_type : char {
+    WAIT,                                                                       // update() blocks on the compositor until it's time to render
+    PREDICTED                                                                   // update() predicts poses without blocking, wait_for_frame() must be called before rendering
+  };
+
+private:
+  #ifndef VRSTORM_DISABLED
+    backend_type backend = backend_type::OPENVR;                                // selected by init()
+    session_recorder recorder;                                                  // flight recorder, fed as each frame is read from the runtime
+    session_replay replay;                                                      // recording the stub plays back, with the replay backend
+  #endif // VRSTORM_DISABLED
+
+public:
+  #ifndef VRSTORM_DISABLED
+    // controllers and trackers are resized by update_events(), so while the frame thread runs only it may touch them - other threads should use the pose snapshot's device masks
+    std::vector<controller> controllers;                                        // connected hand controllers, updated as they connect and disconnect
+    std::vector<controller> trackers;                                           // connected generic trackers, reported as TrackedDeviceClass_Other by this OpenVR version
+    pose_table tracked_poses;                                                   // poses of every tracked device, including those that aren't controllers
     input::controller input_controller;
+    stub_runtime stub;                                                          // settings for the stub backend, applied by init()
+    std::string replay_path;                                                    // session log to play back with the replay backend
   #endif // VRSTORM_DISABLED
-  mat4f hmd_position;
+  std::string render_model_cache_path;                                          // directory to cache packed render models in between runs, empty to disable
+  // hmd_pose, hmd_position, the eye matrices and each controller's pose are written by update_poses() on whichever thread updates - while the frame thread runs, read poses only through get_pose_snapshot()
+  rigid_pose hmd_pose;                                                          // HMD to absolute tracking space
+  mat4f hmd_position;                                                           // inverse of the HMD pose, as a view matrix
 
   float nearplane = 0.2f;                                                       // camera near and far planes
   float farplane = 1000.0f;
@@ -54,21 +207,55 @@ public:
   float head_height = 1.5f;
   bool enabled = false;
 
+  pose_mode_type pose_mode = pose_mode_type::WAIT;                              // how update() acquires poses
+
+  adaptive_resolution resolution{log};                                          // set resolution.enabled to scale the render target with GPU load
+
+  bool end_frame_fence = false;                                                 // end_frame() waits for the GPU to finish the frame, timing the wait
+  float end_frame_fence_timeout_ms = 5.0f;                                      // longest end_frame() will wait on the fence
+
   manager();
   ~manager();
 
-  void init();
+  void init(backend_type backend = backend_type::OPENVR);
   void shutdown();
 
   void update() VRSTORM_CONST_IF_DISABLED;
+  void wait_for_frame() VRSTORM_CONST_IF_DISABLED;
+
+  void start_frame_thread();
+  void stop_frame_thread();
+  bool get_frame_thread_running() const __attribute__((__pure__));
+  pose_snapshot const &get_pose_snapshot(unsigned int reader = 0);              // the only race-free way to read poses while the frame thread runs
 
   vec2<GLsizei> const &get_render_target_size() const __attribute__((__const__));
+  vec2<GLsizei> const &get_scaled_render_target_size();
 
   #ifndef VRSTORM_DISABLED
     std::string get_tracked_device_string(vr::TrackedDeviceIndex_t device_index,
                                           vr::TrackedDeviceProperty prop,
                                           vr::TrackedPropertyError *vr_error = nullptr) const;
+    float get_seconds_to_photons() const;
+    tracked_device_properties const &get_device_properties(vr::TrackedDeviceIndex_t device_index);
+    device_registry const &get_devices() const __attribute__((__const__));
+    render_model_cache &get_render_models() __attribute__((__const__));
+    std::vector<init_phase_timing> const &get_init_timings() const __attribute__((__const__));
+    frame_timing_stats get_frame_timing_stats() const;
+    frame_timing_ring const &get_frame_timings() const __attribute__((__const__));
+    vr::VRTextureBounds_t const &get_render_target_bounds() const __attribute__((__const__));
+
+    void bind_event(  vr::EVREventType event_type, std::function<void(vr::VREvent_t const&)> func);
+    void unbind_event(vr::EVREventType event_type);
     void setup_render_perspective_one_eye(vr::EVREye eye);
+    void draw_hidden_area_mask(vr::EVREye eye);
+    eye_matrices const &get_eye_matrices(vr::EVREye eye) const __attribute__((__pure__));
+    void write_eye_matrices(GLuint uniform_buffer, GLintptr offset = 0) const;
+    void bind_late_latch_uniforms(GLuint binding);
+    void late_latch();
+
+    bool start_recording(std::string const &path, unsigned int capacity = session_recorder::default_capacity);
+    void stop_recording();
+    bool get_recording() const __attribute__((__pure__));
   #endif // VRSTORM_DISABLED
 
   void setup_render_perspective_left()  VRSTORM_CONST_IF_DISABLED;
@@ -76,6 +263,8 @@ public:
 
   void submit_frame_left( GLuint buffer) VRSTORM_CONST_IF_DISABLED;
   void submit_frame_right(GLuint buffer) VRSTORM_CONST_IF_DISABLED;
+  void submit_frame_stereo(GLuint buffer, stereo_layout_type layout = stereo_layout_type::SIDE_BY_SIDE) VRSTORM_CONST_IF_DISABLED;
+  void end_frame() VRSTORM_CONST_IF_DISABLED;
 };
 
 }
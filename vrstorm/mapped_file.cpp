@@ -0,0 +1,159 @@
+#include "mapped_file.h"
+#include <cstdint>
+#ifdef PLATFORM_WINDOWS
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif // PLATFORM_WINDOWS
+
+namespace vrstorm {
+
+mapped_file::~mapped_file() {
+  /// Default destructor
+  close();
+}
+
+bool mapped_file::create(std::string const &path, size_t this_size) {
+  /// Create or truncate a file at the given size and map it for writing; returns false on failure
+  close();
+  #ifdef PLATFORM_WINDOWS
+    HANDLE const file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    file_handle = file;
+    uint64_t const size64 = this_size;
+    HANDLE const mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffff), nullptr); // also extends the file
+    if(!mapping) {
+      close();
+      return false;
+    }
+    mapping_handle = mapping;
+    data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, this_size);
+  #else
+    file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(file_descriptor == -1) {
+      return false;
+    }
+    if(ftruncate(file_descriptor, static_cast<off_t>(this_size)) != 0) {
+      close();
+      return false;
+    }
+    data = mmap(nullptr, this_size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+    if(data == MAP_FAILED) {
+      data = nullptr;
+    }
+  #endif // PLATFORM_WINDOWS
+  if(!data) {
+    close();
+    return false;
+  }
+  size = this_size;
+  writable = true;
+  return true;
+}
+
+bool mapped_file::open(std::string const &path) {
+  /// Map an existing file read-only; returns false on failure
+  close();
+  #ifdef PLATFORM_WINDOWS
+    HANDLE const file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    file_handle = file;
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+      close();
+      return false;
+    }
+    HANDLE const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping) {
+      close();
+      return false;
+    }
+    mapping_handle = mapping;
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    size = static_cast<size_t>(file_size.QuadPart);
+  #else
+    file_descriptor = ::open(path.c_str(), O_RDONLY);
+    if(file_descriptor == -1) {
+      return false;
+    }
+    struct stat file_stat;
+    if(fstat(file_descriptor, &file_stat) != 0 || file_stat.st_size == 0) {     // an empty file can't be mapped
+      close();
+      return false;
+    }
+    size = static_cast<size_t>(file_stat.st_size);
+    data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    if(data == MAP_FAILED) {
+      data = nullptr;
+    }
+  #endif // PLATFORM_WINDOWS
+  if(!data) {
+    close();
+    return false;
+  }
+  writable = false;
+  return true;
+}
+
+void mapped_file::flush() {
+  /// Start writing changes back to disk without waiting for them - they survive a crash of this process either way
+  if(!data || !writable) {
+    return;
+  }
+  #ifdef PLATFORM_WINDOWS
+    FlushViewOfFile(data, 0);
+  #else
+    msync(data, size, MS_ASYNC);
+  #endif // PLATFORM_WINDOWS
+}
+
+void mapped_file::close() {
+  /// Unmap and close the file, if open
+  flush();
+  #ifdef PLATFORM_WINDOWS
+    if(data) {
+      UnmapViewOfFile(data);
+    }
+    if(mapping_handle) {
+      CloseHandle(static_cast<HANDLE>(mapping_handle));
+      mapping_handle = nullptr;
+    }
+    if(file_handle) {
+      CloseHandle(static_cast<HANDLE>(file_handle));
+      file_handle = nullptr;
+    }
+  #else
+    if(data) {
+      munmap(data, size);
+    }
+    if(file_descriptor != -1) {
+      ::close(file_descriptor);
+      file_descriptor = -1;
+    }
+  #endif // PLATFORM_WINDOWS
+  data = nullptr;
+  size = 0;
+  writable = false;
+}
+
+void *mapped_file::get_data() const {
+  /// Return the start of the mapping, or null if not open
+  return data;
+}
+size_t mapped_file::get_size() const {
+  /// Return the size of the mapping in bytes
+  return size;
+}
+bool mapped_file::get_open() const {
+  /// Return whether a file is currently mapped
+  return data != nullptr;
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "platform_defines.h"
+
+namespace vrstorm {
+
+class mapped_file {
+  /// A whole file mapped into memory, either created at a fixed size for writing or opened read-only
+  void *data = nullptr;
+  size_t size = 0;
+  bool writable = false;
+  #ifdef PLATFORM_WINDOWS
+    void *file_handle = nullptr;                                                // HANDLE, kept opaque so windows.h stays out of the header
+    void *mapping_handle = nullptr;
+  #else
+    int file_descriptor = -1;
+  #endif // PLATFORM_WINDOWS
+
+public:
+  mapped_file() = default;
+  mapped_file(mapped_file const&) = delete;
+  mapped_file &operator=(mapped_file const&) = delete;
+  ~mapped_file();
+
+  bool create(std::string const &path, size_t this_size);
+  bool open(std::string const &path);
+  void flush();
+  void close();
+
+  void *get_data() const __attribute__((__pure__));
+  size_t get_size() const __attribute__((__pure__));
+  bool get_open() const __attribute__((__pure__));
+};
+
+}
@@ -0,0 +1,24 @@
+#include "openvr_symbols.h"
+#include "dynamic_load.h"
+
+namespace vrstorm {
+
+void openvr_symbols::load(void *lib) {
+  /// Resolve every entry point we use from the library in one go
+  VR_IsRuntimeInstalled                 = load_symbol<decltype(VR_IsRuntimeInstalled                )>(lib, "VR_IsRuntimeInstalled");
+  VR_RuntimePath                        = load_symbol<decltype(VR_RuntimePath                       )>(lib, "VR_RuntimePath");
+  VR_IsHmdPresent                       = load_symbol<decltype(VR_IsHmdPresent                      )>(lib, "VR_IsHmdPresent");
+  VR_InitInternal                       = load_symbol<decltype(VR_InitInternal                      )>(lib, "VR_InitInternal");
+  VR_ShutdownInternal                   = load_symbol<decltype(VR_ShutdownInternal                  )>(lib, "VR_ShutdownInternal");
+  VR_IsInterfaceVersionValid            = load_symbol<decltype(VR_IsInterfaceVersionValid           )>(lib, "VR_IsInterfaceVersionValid");
+  VR_GetVRInitErrorAsEnglishDescription = load_symbol<decltype(VR_GetVRInitErrorAsEnglishDescription)>(lib, "VR_GetVRInitErrorAsEnglishDescription");
+  VR_GetGenericInterface                = load_symbol<decltype(VR_GetGenericInterface               )>(lib, "VR_GetGenericInterface");
+  VR_GetInitToken                       = load_symbol<decltype(VR_GetInitToken                      )>(lib, "VR_GetInitToken");
+}
+
+void openvr_symbols::clear() {
+  /// Forget all entry points, as when the library is unloaded
+  *this = openvr_symbols();
+}
+
+}
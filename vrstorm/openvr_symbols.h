@@ -0,0 +1,27 @@
+#pragma once
+
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+
+namespace vrstorm {
+
+struct openvr_symbols {
+  /// OpenVR entry points, resolved from the dynamic library once at startup
+  decltype(&vr::VR_IsRuntimeInstalled                ) VR_IsRuntimeInstalled                 = nullptr;
+  decltype(&vr::VR_RuntimePath                       ) VR_RuntimePath                        = nullptr;
+  decltype(&vr::VR_IsHmdPresent                      ) VR_IsHmdPresent                       = nullptr;
+  decltype(&vr::VR_InitInternal                      ) VR_InitInternal                       = nullptr;
+  decltype(&vr::VR_ShutdownInternal                  ) VR_ShutdownInternal                   = nullptr;
+  decltype(&vr::VR_IsInterfaceVersionValid           ) VR_IsInterfaceVersionValid            = nullptr;
+  decltype(&vr::VR_GetVRInitErrorAsEnglishDescription) VR_GetVRInitErrorAsEnglishDescription = nullptr;
+  decltype(&vr::VR_GetGenericInterface               ) VR_GetGenericInterface                = nullptr;
+  decltype(&vr::VR_GetInitToken                      ) VR_GetInitToken                       = nullptr;
+
+  void load(void *lib);
+  void clear();
+};
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "vectorstorm/matrix/matrix4.h"
+
+namespace vrstorm {
+
+struct pose_snapshot {
+  /// A consistent copy of one frame's poses, published by the frame thread
+  uint64_t frame = 0;                                                           // frame number this snapshot was taken on, 0 if nothing has been published yet
+  mat4f hmd_position;                                                           // inverse HMD pose, as manager::hmd_position
+
+  #ifndef VRSTORM_DISABLED
+    std::array<mat4f, vr::k_unMaxTrackedDeviceCount> device_positions;          // device to absolute tracking poses, indexed by tracked device id
+    std::array<bool, vr::k_unMaxTrackedDeviceCount> device_valid{};             // whether each device's pose was valid this frame
+    uint64_t controller_mask = 0;                                               // bit per tracked device id, set for each connected hand controller
+    uint64_t tracker_mask = 0;                                                  // bit per tracked device id, set for each connected generic tracker
+  #endif // VRSTORM_DISABLED
+};
+
+}
@@ -0,0 +1,72 @@
+#include "pose_table.h"
+#ifdef __SSE__
+  #include <xmmintrin.h>
+#endif // __SSE__
+
+namespace vrstorm {
+
+void pose_table::update(std::array<vr::TrackedDevicePose_t, size> const &tracked_device_poses) {
+  /// Convert every tracked device pose into the table in a single pass
+  #ifdef __SSE__
+    // each matrix row is four floats, so load the same row for four devices and transpose to get four devices per element
+    for(unsigned int device = 0; device != size; device += 4) {
+      for(unsigned int row = 0; row != 3; ++row) {
+        __m128 device0 = _mm_loadu_ps(tracked_device_poses[device + 0].mDeviceToAbsoluteTracking.m[row]);
+        __m128 device1 = _mm_loadu_ps(tracked_device_poses[device + 1].mDeviceToAbsoluteTracking.m[row]);
+        __m128 device2 = _mm_loadu_ps(tracked_device_poses[device + 2].mDeviceToAbsoluteTracking.m[row]);
+        __m128 device3 = _mm_loadu_ps(tracked_device_poses[device + 3].mDeviceToAbsoluteTracking.m[row]);
+        _MM_TRANSPOSE4_PS(device0, device1, device2, device3);                  // registers now hold columns 0-3 of this row
+        _mm_store_ps(&matrix[row * 4 + 0][device], device0);
+        _mm_store_ps(&matrix[row * 4 + 1][device], device1);
+        _mm_store_ps(&matrix[row * 4 + 2][device], device2);
+        _mm_store_ps(&matrix[row * 4 + 3][device], device3);
+      }
+    }
+  #else
+    for(unsigned int device = 0; device != size; ++device) {
+      for(unsigned int row = 0; row != 3; ++row) {
+        for(unsigned int col = 0; col != 4; ++col) {
+          matrix[row * 4 + col][device] = tracked_device_poses[device].mDeviceToAbsoluteTracking.m[row][col];
+        }
+      }
+    }
+  #endif // __SSE__
+  uint64_t new_valid_mask     = 0;
+  uint64_t new_connected_mask = 0;
+  for(unsigned int device = 0; device != size; ++device) {
+    new_valid_mask     |= static_cast<uint64_t>(tracked_device_poses[device].bPoseIsValid)       << device;
+    new_connected_mask |= static_cast<uint64_t>(tracked_device_poses[device].bDeviceIsConnected) << device;
+    tracking_result[device] = tracked_device_poses[device].eTrackingResult;
+  }
+  valid_mask     = new_valid_mask;
+  connected_mask = new_connected_mask;
+}
+
+bool pose_table::get_valid(unsigned int device) const {
+  /// Return whether a device's pose was valid on the last update
+  return (valid_mask >> device) & 1;
+}
+bool pose_table::get_connected(unsigned int device) const {
+  /// Return whether a device was connected on the last update
+  return (connected_mask >> device) & 1;
+}
+
+rigid_pose pose_table::get_pose(unsigned int device) const {
+  /// Gather one device's pose out of the table
+  rigid_pose result;
+  for(unsigned int row = 0; row != 3; ++row) {
+    result.rotation[row][0] = matrix[row * 4 + 0][device];
+    result.rotation[row][1] = matrix[row * 4 + 1][device];
+    result.rotation[row][2] = matrix[row * 4 + 2][device];
+  }
+  result.translation.x = matrix[ 3][device];
+  result.translation.y = matrix[ 7][device];
+  result.translation.z = matrix[11][device];
+  return result;
+}
+void pose_table::get_mat4(unsigned int device, mat4f &out) const {
+  /// Gather one device's pose out of the table as a full matrix
+  get_pose(device).to_mat4(out);
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "vectorstorm/matrix/matrix4.h"
+#include "rigid_pose.h"
+
+namespace vrstorm {
+
+class pose_table {
+  /// Structure-of-arrays copy of every tracked device's pose, converted in one pass
+public:
+  static unsigned int constexpr size = vr::k_unMaxTrackedDeviceCount;
+  static unsigned int constexpr elements = 12;                                  // a row-major 3x4 matrix per device
+  static_assert(size % 4 == 0, "pose_table converts four devices at a time");
+  static_assert(size <= 64, "pose_table validity masks are 64 bits wide");
+
+  alignas(16) std::array<std::array<float, size>, elements> matrix;             // matrix[element][device], element in row-major 3x4 order
+  std::array<vr::ETrackingResult, size> tracking_result;
+  uint64_t valid_mask     = 0;                                                  // bit per device, set if its pose is valid
+  uint64_t connected_mask = 0;                                                  // bit per device, set if it's connected
+
+  void update(std::array<vr::TrackedDevicePose_t, size> const &tracked_device_poses);
+
+  bool get_valid(    unsigned int device) const __attribute__((__pure__));
+  bool get_connected(unsigned int device) const __attribute__((__pure__));
+  rigid_pose get_pose(unsigned int device) const __attribute__((__pure__));
+  void get_mat4(unsigned int device, mat4f &out) const;
+};
+
+}
@@ -0,0 +1,370 @@
+#include "render_model_cache.h"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+namespace vrstorm {
+
+namespace {
+
+struct disk_cache_header {
+  /// Layout of the start of a packed render model file, followed by vertices, 16-bit indices and RGBA texture data
+  char magic[4]{'V', 'R', 'S', 'M'};
+  uint32_t version = 2;
+  uint32_t vertex_count = 0;
+  uint32_t index_count = 0;
+  uint64_t texture_hash = 0;                                                    // content hash, zero if there's no texture
+  uint16_t texture_width = 0;
+  uint16_t texture_height = 0;
+};
+
+// limits on what a cache file may claim, so a corrupt one can't make us allocate or index wildly
+uint32_t constexpr max_disk_vertices = 65536;                                   // all that 16-bit indices can address
+uint32_t constexpr max_disk_indices = 3 * 1048576;
+uint16_t constexpr max_disk_texture_size = 8192;
+
+}
+
+render_model_cache::render_model_cache(logger &this_log)
+  : log(this_log) {
+  /// Default constructor
+}
+render_model_cache::~render_model_cache() {
+  /// Default destructor
+  stop_writer();
+}
+
+void render_model_cache::init(std::string const &this_disk_cache_path) {
+  /// Set the directory to cache packed models in, or leave it empty to only cache in memory
+  std::lock_guard<std::mutex> lock(mutex);
+  disk_cache_path = this_disk_cache_path;
+  if(!disk_cache_path.empty() && disk_cache_path.back() != '/') {
+    disk_cache_path += '/';
+  }
+}
+
+void render_model_cache::shutdown() {
+  /// Finish writing the disk cache, then delete all GL objects and forget all models - requires the GL context to be current
+  stop_writer();
+  std::lock_guard<std::mutex> lock(mutex);
+  for(auto const &it : textures) {
+    if(it.second.texture) {
+      glDeleteTextures(1, &it.second.texture);
+    }
+  }
+  if(index_buffer) {
+    glDeleteBuffers(1, &index_buffer);
+  }
+  if(vertex_buffer) {
+    glDeleteBuffers(1, &vertex_buffer);
+  }
+  if(vertex_array) {
+    glDeleteVertexArrays(1, &vertex_array);
+  }
+  index_buffer  = 0;
+  vertex_buffer = 0;
+  vertex_array  = 0;
+  vertices.clear();
+  indices.clear();
+  ranges.clear();
+  textures.clear();
+  dirty = false;
+}
+
+render_model_cache::draw_range const *render_model_cache::add(std::string const &name,
+                                                              vr::RenderModel_t const &model,
+                                                              vr::RenderModel_TextureMap_t const *texture) {
+  /// Add a model loaded from the runtime, queueing it for the disk cache if enabled - the GPU copy is made on the next bind
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const it(ranges.find(name));
+    if(it != ranges.end()) {
+      return &it->second;                                                       // already cached
+    }
+  }
+  uint64_t const texture_hash = texture ? get_texture_hash(texture->unWidth, texture->unHeight, texture->rubTextureMapData) : 0;
+  save_to_disk(name, model, texture, texture_hash);
+  std::lock_guard<std::mutex> lock(mutex);
+  return &pack(name,
+               model.rVertexData,
+               model.unVertexCount,
+               model.rIndexData,
+               model.unTriangleCount * 3,
+               texture_hash,
+               texture ? texture->unWidth : 0,
+               texture ? texture->unHeight : 0,
+               texture ? texture->rubTextureMapData : nullptr);
+}
+
+render_model_cache::draw_range const *render_model_cache::load_from_disk(std::string const &name) {
+  /// Add a model from the disk cache, returning null if it's not there
+  if(disk_cache_path.empty()) {
+    return nullptr;
+  }
+  std::ifstream file(get_disk_cache_filename(name), std::ios::binary);
+  if(!file) {
+    return nullptr;
+  }
+  disk_cache_header header;
+  disk_cache_header const expected_header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!file || std::string(header.magic, sizeof(header.magic)) != std::string(expected_header.magic, sizeof(expected_header.magic)) || header.version != expected_header.version) {
+    log(logger::level::warning) << "VRStorm: Ignoring invalid render model cache file for " << name;
+    return nullptr;
+  }
+  if(header.vertex_count > max_disk_vertices ||
+     header.index_count > max_disk_indices ||
+     header.index_count % 3 != 0 ||
+     header.texture_width > max_disk_texture_size ||
+     header.texture_height > max_disk_texture_size) {
+    log(logger::level::warning) << "VRStorm: Ignoring oversized render model cache file for " << name;
+    return nullptr;
+  }
+  std::vector<vr::RenderModel_Vertex_t> file_vertices(header.vertex_count);
+  std::vector<uint16_t> file_indices(header.index_count);
+  std::vector<uint8_t> file_pixels(static_cast<size_t>(header.texture_width) * header.texture_height * 4);
+  file.read(reinterpret_cast<char*>(file_vertices.data()), static_cast<std::streamsize>(file_vertices.size() * sizeof(vr::RenderModel_Vertex_t)));
+  file.read(reinterpret_cast<char*>(file_indices.data()),  static_cast<std::streamsize>(file_indices.size()  * sizeof(uint16_t)));
+  file.read(reinterpret_cast<char*>(file_pixels.data()),   static_cast<std::streamsize>(file_pixels.size()));
+  if(!file) {
+    log(logger::level::warning) << "VRStorm: Ignoring truncated render model cache file for " << name;
+    return nullptr;
+  }
+  for(auto const index : file_indices) {
+    if(index >= header.vertex_count) {
+      log(logger::level::warning) << "VRStorm: Ignoring render model cache file for " << name << " with out of range index " << index;
+      return nullptr;
+    }
+  }
+  log(logger::level::info) << "VRStorm: Loaded render model " << name << " from disk cache, " << header.vertex_count << " verts, " << header.index_count / 3 << " tris";
+  std::lock_guard<std::mutex> lock(mutex);
+  return &pack(name,
+               file_vertices.data(),
+               header.vertex_count,
+               file_indices.data(),
+               header.index_count,
+               header.texture_hash,
+               header.texture_width,
+               header.texture_height,
+               file_pixels.empty() ? nullptr : file_pixels.data());
+}
+
+render_model_cache::draw_range const *render_model_cache::get(std::string const &name) const {
+  /// Return the draw range of a cached model, or null if it's not cached
+  std::lock_guard<std::mutex> lock(mutex);
+  auto const it(ranges.find(name));
+  if(it == ranges.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void render_model_cache::bind() {
+  /// Upload anything new and bind the shared vertex array, ready to draw models - call from the render thread
+  std::lock_guard<std::mutex> lock(mutex);
+  if(dirty) {
+    upload();
+  }
+  glBindVertexArray(vertex_array);
+}
+
+void render_model_cache::draw(draw_range const &range) const {
+  /// Draw one model with its texture - the cache must be bound
+  glBindTexture(GL_TEXTURE_2D, range.texture);
+  glDrawElements(GL_TRIANGLES,
+                 range.index_count,
+                 GL_UNSIGNED_INT,
+                 reinterpret_cast<void const*>(static_cast<uintptr_t>(range.first_index) * sizeof(GLuint)));
+}
+
+render_model_cache::draw_range &render_model_cache::pack(std::string const &name,
+                                                         vr::RenderModel_Vertex_t const *model_vertices,
+                                                         uint32_t vertex_count,
+                                                         uint16_t const *model_indices,
+                                                         uint32_t index_count,
+                                                         uint64_t texture_hash,
+                                                         GLsizei texture_width,
+                                                         GLsizei texture_height,
+                                                         uint8_t const *texture_pixels) {
+  /// Append a model's geometry to the shared buffers, rebasing its indices - the mutex must be held
+  auto [it, inserted] = ranges.try_emplace(name);
+  draw_range &range = it->second;
+  if(!inserted) {
+    return range;
+  }
+  GLuint const base_vertex = static_cast<GLuint>(vertices.size());
+  vertices.insert(vertices.end(), model_vertices, model_vertices + vertex_count);
+  range.first_index = static_cast<GLuint>(indices.size());
+  range.index_count = static_cast<GLsizei>(index_count);
+  indices.reserve(indices.size() + index_count);
+  for(uint32_t i = 0; i != index_count; ++i) {
+    indices.emplace_back(base_vertex + model_indices[i]);                       // rebased, so every model draws from the same buffers without a base vertex
+  }
+  if(texture_pixels) {
+    range.texture_hash = texture_hash;
+    auto [texture_it, texture_inserted] = textures.try_emplace(texture_hash);  // textures can be shared between models
+    if(texture_inserted) {
+      texture_it->second.width  = texture_width;
+      texture_it->second.height = texture_height;
+      texture_it->second.pixels.assign(texture_pixels, texture_pixels + static_cast<size_t>(texture_width) * texture_height * 4);
+    }
+  }
+  dirty = true;
+  return range;
+}
+
+void render_model_cache::upload() {
+  /// Copy the packed geometry and any new textures to the GPU - the mutex must be held
+  if(!vertex_array) {
+    glGenVertexArrays(1, &vertex_array);
+    glGenBuffers(1, &vertex_buffer);
+    glGenBuffers(1, &index_buffer);
+    glBindVertexArray(vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);                        // element buffer binding is stored in the vertex array
+    glEnableVertexAttribArray(attrib_position);
+    glEnableVertexAttribArray(attrib_normal);
+    glEnableVertexAttribArray(attrib_texcoord);
+    glVertexAttribPointer(attrib_position, 3, GL_FLOAT, GL_FALSE, sizeof(vr::RenderModel_Vertex_t), reinterpret_cast<void const*>(offsetof(vr::RenderModel_Vertex_t, vPosition)));
+    glVertexAttribPointer(attrib_normal,   3, GL_FLOAT, GL_FALSE, sizeof(vr::RenderModel_Vertex_t), reinterpret_cast<void const*>(offsetof(vr::RenderModel_Vertex_t, vNormal)));
+    glVertexAttribPointer(attrib_texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(vr::RenderModel_Vertex_t), reinterpret_cast<void const*>(offsetof(vr::RenderModel_Vertex_t, rfTextureCoord)));
+  } else {
+    glBindVertexArray(vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+  }
+  glBufferData(GL_ARRAY_BUFFER,         static_cast<GLsizeiptr>(vertices.size() * sizeof(vr::RenderModel_Vertex_t)), vertices.data(), GL_STATIC_DRAW);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size()  * sizeof(GLuint)),                   indices.data(),  GL_STATIC_DRAW);
+
+  for(auto &it : textures) {
+    texture_data &this_texture = it.second;
+    if(this_texture.texture || this_texture.pixels.empty()) {
+      continue;                                                                 // already uploaded
+    }
+    glGenTextures(1, &this_texture.texture);
+    glBindTexture(GL_TEXTURE_2D, this_texture.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this_texture.width, this_texture.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, this_texture.pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    this_texture.pixels.clear();
+    this_texture.pixels.shrink_to_fit();                                        // the GPU copy is all we need now
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  for(auto &it : ranges) {
+    auto const texture_it(textures.find(it.second.texture_hash));
+    if(texture_it != textures.end()) {
+      it.second.texture = texture_it->second.texture;
+    }
+  }
+  dirty = false;
+}
+
+uint64_t render_model_cache::get_texture_hash(GLsizei width, GLsizei height, uint8_t const *pixels) {
+  /// Return a 64-bit FNV-1a hash of a texture's size and RGBA pixels, never zero so it can't be mistaken for no texture
+  uint64_t hash = 14695981039346656037ull;
+  auto const hash_bytes = [&](uint8_t const *bytes, size_t size){
+    for(size_t i = 0; i != size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+  };
+  hash_bytes(reinterpret_cast<uint8_t const*>(&width),  sizeof(width));
+  hash_bytes(reinterpret_cast<uint8_t const*>(&height), sizeof(height));
+  hash_bytes(pixels, static_cast<size_t>(width) * height * 4);
+  return hash ? hash : 1;
+}
+
+std::string render_model_cache::get_disk_cache_filename(std::string const &name) const {
+  /// Return the disk cache filename for a model, with any characters unsafe for filenames replaced
+  std::string filename(name);
+  for(auto &it : filename) {
+    if(!((it >= 'a' && it <= 'z') || (it >= 'A' && it <= 'Z') || (it >= '0' && it <= '9') || it == '_' || it == '-' || it == '.')) {
+      it = '_';
+    }
+  }
+  return disk_cache_path + filename + ".vrsmodel";
+}
+
+void render_model_cache::save_to_disk(std::string const &name,
+                                      vr::RenderModel_t const &model,
+                                      vr::RenderModel_TextureMap_t const *texture,
+                                      uint64_t texture_hash) {
+  /// Queue a model loaded from the runtime to be written to the disk cache in the background, if enabled
+  if(disk_cache_path.empty()) {
+    return;
+  }
+  disk_cache_header header;
+  header.vertex_count = model.unVertexCount;
+  header.index_count  = model.unTriangleCount * 3;
+  if(texture) {
+    header.texture_hash   = texture_hash;
+    header.texture_width  = texture->unWidth;
+    header.texture_height = texture->unHeight;
+  }
+  size_t const vertices_size = header.vertex_count * sizeof(vr::RenderModel_Vertex_t);
+  size_t const indices_size  = header.index_count  * sizeof(uint16_t);
+  size_t const pixels_size   = texture ? static_cast<size_t>(header.texture_width) * header.texture_height * 4 : 0;
+  pending_write this_write;
+  this_write.name = name;
+  this_write.filename = get_disk_cache_filename(name);
+  this_write.data.resize(sizeof(header) + vertices_size + indices_size + pixels_size);
+  char *position = this_write.data.data();
+  std::memcpy(position, &header, sizeof(header));
+  position += sizeof(header);
+  std::memcpy(position, model.rVertexData, vertices_size);
+  position += vertices_size;
+  std::memcpy(position, model.rIndexData, indices_size);
+  position += indices_size;
+  if(texture) {
+    std::memcpy(position, texture->rubTextureMapData, pixels_size);
+  }
+
+  std::lock_guard<std::mutex> lock(writer_mutex);
+  writes.emplace_back(std::move(this_write));
+  if(!writer_running) {
+    if(writer_thread.joinable()) {
+      writer_thread.join();                                                     // stopped earlier, nothing left for it to do
+    }
+    writer_running = true;
+    writer_thread = std::thread(&render_model_cache::writer_loop, this);
+  }
+  writer_wake.notify_one();
+}
+
+void render_model_cache::writer_loop() {
+  /// Body of the disk cache writer thread, writes queued files until stopped and the queue is empty
+  for(;;) {
+    pending_write this_write;
+    {
+      std::unique_lock<std::mutex> lock(writer_mutex);
+      writer_wake.wait(lock, [this]{return !writes.empty() || !writer_running;});
+      if(writes.empty()) {
+        return;                                                                 // only once stopped, so nothing queued is lost
+      }
+      this_write = std::move(writes.front());
+      writes.pop_front();
+    }
+    std::ofstream file(this_write.filename, std::ios::binary | std::ios::trunc);
+    if(!file) {
+      log(logger::level::warning) << "VRStorm: Unable to write render model cache file for " << this_write.name << " at " << this_write.filename; // not fatal, we just load from the runtime again next time
+      continue;
+    }
+    file.write(this_write.data.data(), static_cast<std::streamsize>(this_write.data.size()));
+  }
+}
+
+void render_model_cache::stop_writer() {
+  /// Finish any queued disk cache writes and stop the writer thread
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    writer_running = false;
+  }
+  writer_wake.notify_one();
+  if(writer_thread.joinable()) {
+    writer_thread.join();
+  }
+}
+
+}
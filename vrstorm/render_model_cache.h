@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "logger.h"
+
+namespace vrstorm {
+
+class render_model_cache {
+  /// Packs every loaded render model into one shared vertex and index buffer, with an optional on-disk copy of the packed data
+public:
+  struct draw_range {
+    GLuint first_index = 0;                                                     // offset into the shared index buffer, in indices
+    GLsizei index_count = 0;
+    uint64_t texture_hash = 0;                                                  // content hash of the texture, zero if the model has none
+    GLuint texture = 0;                                                         // GL texture name, zero until uploaded or if the model has none
+  };
+
+  // vertex attribute locations in the shared vertex array
+  static GLuint constexpr attrib_position = 0;
+  static GLuint constexpr attrib_normal   = 1;
+  static GLuint constexpr attrib_texcoord = 2;
+
+private:
+  struct texture_data {
+    GLuint texture = 0;
+    GLsizei width = 0;
+    GLsizei height = 0;
+    std::vector<uint8_t> pixels;                                                // RGBA, released once uploaded
+  };
+
+  logger &log;
+  std::string disk_cache_path;                                                  // directory for packed models, empty to disable the disk cache
+
+  mutable std::mutex mutex;                                                     // models may be added from the frame thread, but are uploaded on the render thread
+  std::vector<vr::RenderModel_Vertex_t> vertices;
+  std::vector<GLuint> indices;
+  std::unordered_map<std::string, draw_range> ranges;                           // by model name, pointers to these remain valid until shutdown
+  std::unordered_map<uint64_t, texture_data> textures;                          // by content hash, as runtime texture ids aren't stable between sessions
+  bool dirty = false;                                                           // geometry or textures need uploading
+
+  GLuint vertex_array  = 0;
+  GLuint vertex_buffer = 0;
+  GLuint index_buffer  = 0;
+
+  struct pending_write {
+    std::string name;
+    std::string filename;
+    std::vector<char> data;                                                     // the whole file, copied so the runtime's model can be freed
+  };
+
+  std::thread writer_thread;                                                    // writes the disk cache, started with the first model to save
+  std::mutex writer_mutex;
+  std::condition_variable writer_wake;
+  std::deque<pending_write> writes;                                             // guarded by writer_mutex
+  bool writer_running = false;                                                  // guarded by writer_mutex
+
+public:
+  explicit render_model_cache(logger &this_log);
+  ~render_model_cache();
+
+  void init(std::string const &this_disk_cache_path = {});
+  void shutdown();
+
+  draw_range const *add(std::string const &name,
+                        vr::RenderModel_t const &model,
+                        vr::RenderModel_TextureMap_t const *texture);
+  draw_range const *load_from_disk(std::string const &name);
+  draw_range const *get(std::string const &name) const;
+
+  void bind();
+  void draw(draw_range const &range) const;
+
+private:
+  draw_range &pack(std::string const &name,
+                   vr::RenderModel_Vertex_t const *model_vertices,
+                   uint32_t vertex_count,
+                   uint16_t const *model_indices,
+                   uint32_t index_count,
+                   uint64_t texture_hash,
+                   GLsizei texture_width,
+                   GLsizei texture_height,
+                   uint8_t const *texture_pixels);
+  void upload();
+  static uint64_t get_texture_hash(GLsizei width, GLsizei height, uint8_t const *pixels) __attribute__((__pure__));
+  std::string get_disk_cache_filename(std::string const &name) const __attribute__((__pure__));
+  void save_to_disk(std::string const &name,
+                    vr::RenderModel_t const &model,
+                    vr::RenderModel_TextureMap_t const *texture,
+                    uint64_t texture_hash);
+  void writer_loop();
+  void stop_writer();
+};
+
+}
@@ -0,0 +1,140 @@
+#include "render_model_loader.h"
+
+namespace vrstorm {
+
+render_model_loader::render_model_loader(logger &this_log)
+  : log(this_log) {
+  /// Default constructor
+}
+
+void render_model_loader::init(vr::IVRRenderModels *this_render_models) {
+  /// Set the render model interface to load from
+  render_models = this_render_models;
+}
+
+void render_model_loader::shutdown() {
+  /// Free all loaded models and textures - must happen before the runtime is shut down
+  if(render_models) {
+    for(auto &it : models) {
+      if(it.second.model) {
+        render_models->FreeRenderModel(it.second.model);
+      }
+    }
+    for(auto &it : textures) {
+      if(it.second) {
+        render_models->FreeTexture(it.second);
+      }
+    }
+  }
+  models.clear();
+  textures.clear();
+  pending = 0;
+  render_models = nullptr;
+}
+
+void render_model_loader::load(std::string const &name, callback_type callback) {
+  /// Request a render model, calling back when it and its texture are loaded, immediately if they already are
+  if(!render_models) {
+    return;
+  }
+  auto [it, inserted] = models.try_emplace(name);
+  entry &this_entry = it->second;
+  switch(this_entry.state) {
+  case statetype::READY:
+    if(callback) {
+      callback(this_entry.model, this_entry.texture);
+    }
+    return;
+  case statetype::FAILED:
+    return;
+  default:
+    if(callback) {
+      this_entry.callbacks.emplace_back(callback);
+    }
+    break;
+  }
+  if(inserted) {
+    log(logger::level::info) << "VRStorm: Loading render model " << name << " in the background";
+    ++pending;
+    if(update_entry(name, this_entry)) {                                        // start the request now, in case it's already available
+      finish_entry(this_entry);
+    }
+  }
+}
+
+void render_model_loader::update() {
+  /// Poll the runtime for any outstanding models and textures, without blocking
+  if(pending == 0) {
+    return;                                                                     // early exit for the usual case
+  }
+  std::vector<entry*> finished;                                                 // callbacks are deferred, so they're free to request more loads
+  for(auto &it : models) {
+    if(it.second.state == statetype::LOADING_MODEL || it.second.state == statetype::LOADING_TEXTURE) {
+      if(update_entry(it.first, it.second)) {
+        finished.emplace_back(&it.second);                                      // map nodes are stable, so this stays valid
+      }
+    }
+  }
+  for(auto const &it : finished) {
+    finish_entry(*it);
+  }
+}
+
+bool render_model_loader::get_loading() const {
+  /// Return whether any models are still loading
+  return pending != 0;
+}
+
+bool render_model_loader::update_entry(std::string const &name, entry &this_entry) {
+  /// Advance loading of one model, returning true if it has just finished
+  if(this_entry.state == statetype::LOADING_MODEL) {
+    vr::EVRRenderModelError const model_load_error = render_models->LoadRenderModel_Async(name.c_str(), &this_entry.model);
+    if(model_load_error == vr::VRRenderModelError_Loading) {
+      return false;
+    }
+    if(model_load_error != vr::VRRenderModelError_None || !this_entry.model) {
+      log(logger::level::error) << "VRStorm: Failed to load render model: " << name;
+      this_entry.model = nullptr;
+      this_entry.state = statetype::FAILED;
+      this_entry.callbacks.clear();
+      --pending;
+      return false;
+    }
+    log(logger::level::info) << "VRStorm: Loaded render model " << name << ", " << this_entry.model->unVertexCount << " verts, " << this_entry.model->unTriangleCount << " tris";
+    if(this_entry.model->diffuseTextureId == vr::INVALID_TEXTURE_ID) {
+      this_entry.state = statetype::READY;
+      --pending;
+      return true;
+    }
+    this_entry.state = statetype::LOADING_TEXTURE;
+  }
+  if(this_entry.state == statetype::LOADING_TEXTURE) {
+    vr::RenderModel_TextureMap_t *&texture = textures[this_entry.model->diffuseTextureId];
+    if(!texture) {
+      vr::EVRRenderModelError const texture_load_error = render_models->LoadTexture_Async(this_entry.model->diffuseTextureId, &texture);
+      if(texture_load_error == vr::VRRenderModelError_Loading) {
+        return false;
+      }
+      if(texture_load_error != vr::VRRenderModelError_None) {
+        log(logger::level::warning) << "VRStorm: Failed to load texture " << this_entry.model->diffuseTextureId << " for render model " << name << ", continuing without it";
+        texture = nullptr;
+      }
+    }
+    this_entry.texture = texture;
+    this_entry.state = statetype::READY;
+    --pending;
+    return true;
+  }
+  return false;
+}
+
+void render_model_loader::finish_entry(entry &this_entry) {
+  /// Pass a newly loaded model to everything waiting for it
+  std::vector<callback_type> callbacks;
+  callbacks.swap(this_entry.callbacks);
+  for(auto const &it : callbacks) {
+    it(this_entry.model, this_entry.texture);
+  }
+}
+
+}
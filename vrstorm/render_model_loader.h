@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "logger.h"
+
+namespace vrstorm {
+
+class render_model_loader {
+  /// Loads render models and their textures incrementally without blocking, deduplicated by name
+public:
+  using callback_type = std::function<void(vr::RenderModel_t*, vr::RenderModel_TextureMap_t*)>;
+
+  enum class statetype : char {
+    LOADING_MODEL,
+    LOADING_TEXTURE,
+    READY,
+    FAILED
+  };
+
+private:
+  struct entry {
+    statetype state = statetype::LOADING_MODEL;
+    vr::RenderModel_t *model = nullptr;
+    vr::RenderModel_TextureMap_t *texture = nullptr;                            // may remain null if the model has no texture
+    std::vector<callback_type> callbacks;                                       // waiting to be called when loading finishes
+  };
+
+  logger &log;
+  vr::IVRRenderModels *render_models = nullptr;
+  std::unordered_map<std::string, entry> models;
+  std::unordered_map<vr::TextureID_t, vr::RenderModel_TextureMap_t*> textures;  // textures can be shared between models
+  unsigned int pending = 0;                                                     // number of models still loading
+
+public:
+  explicit render_model_loader(logger &this_log);
+
+  void init(vr::IVRRenderModels *this_render_models);
+  void shutdown();
+
+  void load(std::string const &name, callback_type callback = nullptr);
+  void update();
+
+  bool get_loading() const __attribute__((__pure__));
+
+private:
+  bool update_entry(std::string const &name, entry &this_entry);
+  static void finish_entry(entry &this_entry);
+};
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include "vectorstorm/vector/vector3.h"
+#include "vectorstorm/matrix/matrix4.h"
+
+namespace vrstorm {
+
+struct rigid_pose {
+  /// A rigid transform - an orthonormal rotation followed by a translation - with an exact, cheap inverse
+  std::array<std::array<float, 3>, 3> rotation{{{1.0f, 0.0f, 0.0f},             // row-major, as OpenVR supplies it
+                                                {0.0f, 1.0f, 0.0f},
+                                                {0.0f, 0.0f, 1.0f}}};
+  vec3f translation{0.0f, 0.0f, 0.0f};
+
+  static rigid_pose from_row_major_34_array(float const *values) __attribute__((__pure__));
+
+  rigid_pose inverse() const __attribute__((__pure__));
+  rigid_pose operator*(rigid_pose const &rhs) const __attribute__((__pure__));
+  vec3f transform(vec3f const &point) const __attribute__((__pure__));
+
+  mat4f to_mat4() const __attribute__((__pure__));
+  void to_mat4(mat4f &out) const;
+};
+
+inline rigid_pose rigid_pose::from_row_major_34_array(float const *values) {
+  /// Construct from a row-major 3x4 matrix such as vr::HmdMatrix34_t, which must be rigid
+  rigid_pose result;
+  for(unsigned int row = 0; row != 3; ++row) {
+    result.rotation[row][0] = values[row * 4 + 0];
+    result.rotation[row][1] = values[row * 4 + 1];
+    result.rotation[row][2] = values[row * 4 + 2];
+  }
+  result.translation.x = values[ 3];
+  result.translation.y = values[ 7];
+  result.translation.z = values[11];
+  return result;
+}
+
+inline rigid_pose rigid_pose::inverse() const {
+  /// Exact inverse: the rotation is transposed, and the translation rotated back and negated
+  rigid_pose result;
+  for(unsigned int row = 0; row != 3; ++row) {
+    for(unsigned int col = 0; col != 3; ++col) {
+      result.rotation[row][col] = rotation[col][row];
+    }
+  }
+  result.translation.x = -(rotation[0][0] * translation.x + rotation[1][0] * translation.y + rotation[2][0] * translation.z);
+  result.translation.y = -(rotation[0][1] * translation.x + rotation[1][1] * translation.y + rotation[2][1] * translation.z);
+  result.translation.z = -(rotation[0][2] * translation.x + rotation[1][2] * translation.y + rotation[2][2] * translation.z);
+  return result;
+}
+
+inline rigid_pose rigid_pose::operator*(rigid_pose const &rhs) const {
+  /// Composition, applying rhs first and then this transform, as with matrix multiplication
+  rigid_pose result;
+  for(unsigned int row = 0; row != 3; ++row) {
+    for(unsigned int col = 0; col != 3; ++col) {
+      result.rotation[row][col] = rotation[row][0] * rhs.rotation[0][col] +
+                                  rotation[row][1] * rhs.rotation[1][col] +
+                                  rotation[row][2] * rhs.rotation[2][col];
+    }
+  }
+  result.translation = transform(rhs.translation);
+  return result;
+}
+
+inline vec3f rigid_pose::transform(vec3f const &point) const {
+  /// Transform a point by this pose
+  return vec3f(rotation[0][0] * point.x + rotation[0][1] * point.y + rotation[0][2] * point.z + translation.x,
+               rotation[1][0] * point.x + rotation[1][1] * point.y + rotation[1][2] * point.z + translation.y,
+               rotation[2][0] * point.x + rotation[2][1] * point.y + rotation[2][2] * point.z + translation.z);
+}
+
+inline mat4f rigid_pose::to_mat4() const {
+  /// Expand to a full column-major 4x4 matrix
+  mat4f result;
+  to_mat4(result);
+  return result;
+}
+
+inline void rigid_pose::to_mat4(mat4f &out) const {
+  /// Expand to a full column-major 4x4 matrix, in place
+  for(unsigned int col = 0; col != 3; ++col) {
+    out.data[col * 4 + 0] = rotation[0][col];
+    out.data[col * 4 + 1] = rotation[1][col];
+    out.data[col * 4 + 2] = rotation[2][col];
+    out.data[col * 4 + 3] = 0.0f;
+  }
+  out.data[12] = translation.x;
+  out.data[13] = translation.y;
+  out.data[14] = translation.z;
+  out.data[15] = 1.0f;
+}
+
+}
@@ -0,0 +1,149 @@
+#include "session_log.h"
+#include <algorithm>
+#include <new>
+
+namespace vrstorm {
+
+bool session_recorder::start(std::string const &path, session_log_devices const &devices, unsigned int capacity) {
+  /// Create a log file holding the given number of most recent frames, and start recording into it; returns false on failure
+  stop();
+  capacity = std::max(capacity, 2u);                                            // one slot is always being written
+  if(!file.create(path, sizeof(session_log_header) + sizeof(session_log_frame) * capacity)) {
+    return false;
+  }
+  header = new(file.get_data()) session_log_header;
+  header->frame_size = sizeof(session_log_frame);
+  header->capacity = capacity;
+  header->devices = devices;
+  frames = reinterpret_cast<session_log_frame*>(static_cast<char*>(file.get_data()) + sizeof(session_log_header));
+  current = nullptr;
+  start_time = std::chrono::steady_clock::now();
+  return true;
+}
+
+void session_recorder::stop() {
+  /// Finish the frame in progress and close the log
+  if(!header) {
+    return;
+  }
+  finish_frame();
+  file.close();
+  header = nullptr;
+  frames = nullptr;
+}
+
+void session_recorder::record_frame(std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> const &poses) {
+  /// Finish the previous frame and start a new one with these poses - events and controller states that follow belong to it
+  if(!header) {
+    return;
+  }
+  finish_frame();
+  uint64_t const number = header->frames_written;
+  current = &frames[number % header->capacity];                                 // overwrites the oldest frame once the ring is full
+  current->number = number;
+  current->time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  current->event_count = 0;
+  current->events_dropped = 0;
+  current->controller_mask = 0;                                                 // states and events beyond the counts are left stale, not cleared
+  current->render_poses_recorded = 0;
+  current->poses = poses;
+}
+
+void session_recorder::record_render_poses(std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> const &poses) {
+  /// Add the poses the current frame is rendered with, when they're read separately from the ones update() used
+  if(!current) {
+    return;
+  }
+  current->render_poses = poses;
+  current->render_poses_recorded = 1;
+}
+
+void session_recorder::record_event(vr::VREvent_t const &event) {
+  /// Add an event to the current frame
+  if(!current) {
+    return;
+  }
+  if(current->event_count == session_log_frame::max_events) {
+    ++current->events_dropped;
+    return;
+  }
+  current->events[current->event_count] = event;
+  ++current->event_count;
+}
+
+void session_recorder::record_controller_state(vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t const &state) {
+  /// Add a controller state polled for the current frame
+  if(!current || device_index >= vr::k_unMaxTrackedDeviceCount) {
+    return;
+  }
+  current->controller_states[device_index] = state;
+  current->controller_mask |= uint64_t{1} << device_index;
+}
+
+bool session_recorder::get_recording() const {
+  /// Return whether a log is open for recording
+  return header != nullptr;
+}
+
+void session_recorder::finish_frame() {
+  /// Count the current frame as written - until then, a crash leaves it out of the log
+  if(!current) {
+    return;
+  }
+  header->frames_written = current->number + 1;
+  current = nullptr;
+}
+
+bool session_replay::open(std::string const &path) {
+  /// Map a session log for replay, checking it was written by a compatible build; returns false on failure
+  close();
+  if(!file.open(path)) {
+    return false;
+  }
+  auto const *this_header = static_cast<session_log_header const*>(file.get_data());
+  session_log_header const expected;
+  if(file.get_size() < sizeof(session_log_header) ||
+     this_header->magic != expected.magic ||
+     this_header->version != session_log_header::current_version ||
+     this_header->frame_size != sizeof(session_log_frame) ||
+     this_header->capacity < 2 ||
+     file.get_size() < sizeof(session_log_header) + sizeof(session_log_frame) * this_header->capacity ||
+     this_header->frames_written == 0) {
+    close();
+    return false;
+  }
+  header = this_header;
+  frames = reinterpret_cast<session_log_frame const*>(static_cast<char const*>(file.get_data()) + sizeof(session_log_header));
+  uint64_t const kept = header->capacity - 1;                                   // the slot after the newest frame may have been partly overwritten
+  first = header->frames_written > kept ? header->frames_written - kept : 0;
+  count = header->frames_written - first;
+  return true;
+}
+
+void session_replay::close() {
+  /// Unmap the log
+  file.close();
+  header = nullptr;
+  frames = nullptr;
+  first = 0;
+  count = 0;
+}
+
+bool session_replay::get_open() const {
+  /// Return whether a log is open for replay
+  return header != nullptr;
+}
+session_log_devices const &session_replay::get_devices() const {
+  /// Return the runtime details captured when the log was recorded
+  return header->devices;
+}
+uint64_t session_replay::get_frame_count() const {
+  /// Return the number of frames available to replay
+  return count;
+}
+session_log_frame const &session_replay::get_frame(uint64_t index) const {
+  /// Return a frame by its position from the oldest kept, holding on the newest past the end
+  return frames[(first + std::min(index, count - 1)) % header->capacity];
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "mapped_file.h"
+
+namespace vrstorm {
+
+struct session_log_devices {
+  /// Runtime details captured when recording starts, enough to stand in for the runtime on replay
+  float display_frequency = 0.0f;
+  float vsync_to_photon_time = 0.0f;
+  float user_ipd = 0.0f;
+  uint32_t padding = 0;
+  std::array<int32_t, vr::k_unMaxTrackedDeviceCount> device_classes{};         // vr::ETrackedDeviceClass of each device id
+  std::array<int32_t, vr::k_unMaxTrackedDeviceCount> roles{};                  // vr::ETrackedControllerRole of each device id
+};
+
+struct session_log_header {
+  /// Start of a session log file, followed by a ring of fixed-size frames
+  static uint32_t constexpr current_version = 2;
+
+  std::array<char, 8> magic{{'V', 'R', 'S', 'T', 'L', 'O', 'G', '\0'}};
+  uint32_t version = current_version;
+  uint32_t frame_size = 0;                                                      // logs from builds with a different frame layout are rejected
+  uint32_t capacity = 0;                                                        // frame slots in the ring
+  uint32_t padding = 0;
+  uint64_t frames_written = 0;                                                  // frames completed, including any since overwritten
+  session_log_devices devices;
+};
+
+struct session_log_frame {
+  /// Everything read from the runtime during one update, stored as it was read
+  static unsigned int constexpr max_events = 16;                                // further events in the same frame are counted but not kept
+  static_assert(vr::k_unMaxTrackedDeviceCount <= 64, "session_log_frame controller masks are 64 bits wide");
+
+  uint64_t number = 0;                                                          // frames since recording started
+  double time = 0.0;                                                            // seconds since recording started, when the poses were read
+  uint32_t event_count = 0;                                                     // events kept below
+  uint32_t events_dropped = 0;
+  uint64_t controller_mask = 0;                                                 // a bit for each device id polled for controller state this frame
+  uint32_t render_poses_recorded = 0;                                           // nonzero if the poses rendered with were read separately, after update()
+  uint32_t padding = 0;
+  std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> poses;    // as read by update()
+  std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> render_poses; // as read by wait_for_frame(), when render_poses_recorded is set
+  std::array<vr::VRControllerState_t, vr::k_unMaxTrackedDeviceCount> controller_states;
+  std::array<vr::VREvent_t, max_events> events;
+};
+
+class session_recorder {
+  /// Bounded flight recorder, writing each frame's poses, controller states and events into a memory-mapped ring
+  mapped_file file;
+  session_log_header *header = nullptr;                                         // null when not recording
+  session_log_frame *frames = nullptr;
+  session_log_frame *current = nullptr;                                         // frame being filled, null until the first poses arrive
+  std::chrono::steady_clock::time_point start_time;
+
+public:
+  static unsigned int constexpr default_capacity = 5400;                        // a minute at 90Hz, about 22MB
+
+  bool start(std::string const &path, session_log_devices const &devices, unsigned int capacity = default_capacity);
+  void stop();
+
+  void record_frame(std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> const &poses);
+  void record_render_poses(std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> const &poses);
+  void record_event(vr::VREvent_t const &event);
+  void record_controller_state(vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t const &state);
+
+  bool get_recording() const __attribute__((__pure__));
+
+private:
+  void finish_frame();
+};
+
+class session_replay {
+  /// Read-only view of a memory-mapped session log, for playing a recording back in place of the runtime
+  mapped_file file;
+  session_log_header const *header = nullptr;                                   // null when no log is open
+  session_log_frame const *frames = nullptr;
+  uint64_t first = 0;                                                           // oldest frame still held in the ring
+  uint64_t count = 0;
+
+public:
+  bool open(std::string const &path);
+  void close();
+
+  bool get_open() const __attribute__((__pure__));
+  session_log_devices const &get_devices() const __attribute__((__pure__));
+  uint64_t get_frame_count() const __attribute__((__pure__));
+  session_log_frame const &get_frame(uint64_t index) const __attribute__((__pure__));
+};
+
+}
@@ -0,0 +1,941 @@
+#include "stub_runtime.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace vrstorm {
+
+namespace {
+
+std::array<vr::EVRButtonId, 4> constexpr stub_buttons{                          // buttons the synthetic events cycle through
+  vr::k_EButton_ApplicationMenu,
+  vr::k_EButton_Grip,
+  vr::k_EButton_SteamVR_Trigger,
+  vr::k_EButton_SteamVR_Touchpad
+};
+
+uint32_t constexpr stub_init_token = 1;
+
+uint64_t constexpr button_mask(vr::EVRButtonId button) {
+  /// Return the bit for a button in the controller state masks
+  return 1ull << button;
+}
+
+vr::HmdMatrix34_t identity_matrix34() {
+  /// Return an identity transform
+  return {{{1.0f, 0.0f, 0.0f, 0.0f},
+           {0.0f, 1.0f, 0.0f, 0.0f},
+           {0.0f, 0.0f, 1.0f, 0.0f}}};
+}
+
+vr::HmdMatrix34_t yaw_matrix34(float yaw, float x, float y, float z) {
+  /// Return a transform rotating about the vertical axis, then translating
+  float const c = std::cos(yaw);
+  float const s = std::sin(yaw);
+  return {{{   c, 0.0f,    s,    x},
+           {0.0f, 1.0f, 0.0f,    y},
+           {  -s, 0.0f,    c,    z}}};
+}
+
+void rotate_vector(vr::HmdMatrix34_t const &transform, vr::HmdVector3_t &vector) {
+  /// Rotate a vector in place by the rotation part of a transform
+  vr::HmdVector3_t const source = vector;
+  for(unsigned int row = 0; row != 3; ++row) {
+    vector.v[row] = transform.m[row][0] * source.v[0] + transform.m[row][1] * source.v[1] + transform.m[row][2] * source.v[2];
+  }
+}
+
+void set_error(vr::ETrackedPropertyError *error, vr::ETrackedPropertyError value) {
+  /// Report a property error, if the caller asked for one
+  if(error) {
+    *error = value;
+  }
+}
+
+}
+
+stub_runtime *stub_runtime::active = nullptr;
+
+stub_runtime::system_interface::system_interface(stub_runtime &this_parent)
+  : parent(this_parent) {
+  /// Default constructor
+}
+
+void stub_runtime::system_interface::GetRecommendedRenderTargetSize(uint32_t *width, uint32_t *height) {
+  /// Report a typical per-eye render target size
+  *width  = 1512;
+  *height = 1680;
+}
+vr::HmdMatrix44_t stub_runtime::system_interface::GetProjectionMatrix(vr::EVREye eye, float near_z, float far_z, vr::EGraphicsAPIConvention convention) {
+  /// Build a projection matrix from the raw frustum, as the runtime does
+  float left, right, top, bottom;
+  GetProjectionRaw(eye, &left, &right, &top, &bottom);
+  float const idx = 1.0f / (right - left);
+  float const idy = 1.0f / (bottom - top);
+  vr::HmdMatrix44_t matrix{};
+  matrix.m[0][0] = 2.0f * idx;
+  matrix.m[0][2] = (right + left) * idx;
+  matrix.m[1][1] = 2.0f * idy;
+  matrix.m[1][2] = (top + bottom) * idy;
+  if(convention == vr::API_OpenGL) {
+    matrix.m[2][2] = -(far_z + near_z) / (far_z - near_z);
+    matrix.m[2][3] = -2.0f * far_z * near_z / (far_z - near_z);
+  } else {
+    matrix.m[2][2] = far_z / (near_z - far_z);
+    matrix.m[2][3] = far_z * near_z / (near_z - far_z);
+  }
+  matrix.m[3][2] = -1.0f;
+  return matrix;
+}
+void stub_runtime::system_interface::GetProjectionRaw(vr::EVREye eye, float *left, float *right, float *top, float *bottom) {
+  /// Report a slightly asymmetric frustum, wider on the outside of each eye
+  *left   = eye == vr::Eye_Left ? -1.4f : -1.2f;
+  *right  = eye == vr::Eye_Left ?  1.2f :  1.4f;
+  *top    = -1.3f;
+  *bottom =  1.3f;
+}
+vr::DistortionCoordinates_t stub_runtime::system_interface::ComputeDistortion(vr::EVREye eye [[maybe_unused]], float u, float v) {
+  /// No lens distortion
+  return {{u, v}, {u, v}, {u, v}};
+}
+vr::HmdMatrix34_t stub_runtime::system_interface::GetEyeToHeadTransform(vr::EVREye eye) {
+  /// Offset each eye by half the reported IPD
+  vr::HmdMatrix34_t transform = identity_matrix34();
+  transform.m[0][3] = GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float, nullptr) * (eye == vr::Eye_Left ? -0.5f : 0.5f);
+  return transform;
+}
+bool stub_runtime::system_interface::GetTimeSinceLastVsync(float *seconds_since_vsync, uint64_t *frame_counter) {
+  /// Report time since the last frame boundary - always zero when not paced, as time stands still between frames
+  if(seconds_since_vsync) {
+    *seconds_since_vsync = 0.0f;
+    if(parent.paced) {
+      float const elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - parent.start_time).count();
+      *seconds_since_vsync = std::fmod(elapsed, 1.0f / parent.frame_rate);
+    }
+  }
+  if(frame_counter) {
+    *frame_counter = parent.get_frame();
+  }
+  return true;
+}
+int32_t stub_runtime::system_interface::GetD3D9AdapterIndex() {
+  /// There is no display adapter
+  return -1;
+}
+void stub_runtime::system_interface::GetDXGIOutputInfo(int32_t *adapter_index) {
+  /// There is no display adapter
+  *adapter_index = -1;
+}
+bool stub_runtime::system_interface::IsDisplayOnDesktop() {
+  /// There is no display
+  return false;
+}
+bool stub_runtime::system_interface::SetDisplayVisibility(bool visible_on_desktop [[maybe_unused]]) {
+  /// There is no display
+  return false;
+}
+void stub_runtime::system_interface::GetDeviceToAbsoluteTrackingPose(vr::ETrackingUniverseOrigin origin [[maybe_unused]],
+                                                                     float predicted_seconds,
+                                                                     vr::TrackedDevicePose_t *poses,
+                                                                     uint32_t pose_count) {
+  /// Sample every device's motion the given time after the current frame - or as rendered with, for a replayed late latch
+  if(parent.fill_replay_render_poses(poses, pose_count)) {
+    return;
+  }
+  parent.fill_poses(parent.get_time() + predicted_seconds, poses, pose_count);
+}
+void stub_runtime::system_interface::ResetSeatedZeroPose() {
+  /// The seated zero pose is fixed
+}
+vr::HmdMatrix34_t stub_runtime::system_interface::GetSeatedZeroPoseToStandingAbsoluteTrackingPose() {
+  /// Seated and standing spaces coincide
+  return identity_matrix34();
+}
+vr::HmdMatrix34_t stub_runtime::system_interface::GetRawZeroPoseToStandingAbsoluteTrackingPose() {
+  /// Raw and standing spaces coincide
+  return identity_matrix34();
+}
+uint32_t stub_runtime::system_interface::GetSortedTrackedDeviceIndicesOfClass(vr::ETrackedDeviceClass device_class,
+                                                                              vr::TrackedDeviceIndex_t *indices,
+                                                                              uint32_t index_count,
+                                                                              vr::TrackedDeviceIndex_t relative_to [[maybe_unused]]) {
+  /// List devices of a class in index order, returning how many there are even if they don't all fit
+  uint32_t count = 0;
+  for(vr::TrackedDeviceIndex_t i = 0; i != vr::k_unMaxTrackedDeviceCount; ++i) {
+    if(GetTrackedDeviceClass(i) != device_class) {
+      continue;
+    }
+    if(indices && count < index_count) {
+      indices[count] = i;
+    }
+    ++count;
+  }
+  return count;
+}
+vr::EDeviceActivityLevel stub_runtime::system_interface::GetTrackedDeviceActivityLevel(vr::TrackedDeviceIndex_t device_index) {
+  /// Every synthetic device is in use
+  return parent.is_connected(device_index) ? vr::k_EDeviceActivityLevel_UserInteraction : vr::k_EDeviceActivityLevel_Unknown;
+}
+void stub_runtime::system_interface::ApplyTransform(vr::TrackedDevicePose_t *output_pose, vr::TrackedDevicePose_t const *pose, vr::HmdMatrix34_t const *transform) {
+  /// Transform a pose into another space
+  *output_pose = *pose;
+  for(unsigned int row = 0; row != 3; ++row) {
+    for(unsigned int column = 0; column != 4; ++column) {
+      output_pose->mDeviceToAbsoluteTracking.m[row][column] = transform->m[row][0] * pose->mDeviceToAbsoluteTracking.m[0][column]
+                                                            + transform->m[row][1] * pose->mDeviceToAbsoluteTracking.m[1][column]
+                                                            + transform->m[row][2] * pose->mDeviceToAbsoluteTracking.m[2][column]
+                                                            + (column == 3 ? transform->m[row][3] : 0.0f);
+    }
+  }
+  rotate_vector(*transform, output_pose->vVelocity);
+  rotate_vector(*transform, output_pose->vAngularVelocity);
+}
+vr::TrackedDeviceIndex_t stub_runtime::system_interface::GetTrackedDeviceIndexForControllerRole(vr::ETrackedControllerRole role) {
+  /// The first controller is the left hand and the second the right
+  for(vr::TrackedDeviceIndex_t i = 0; i != vr::k_unMaxTrackedDeviceCount; ++i) {
+    if(GetControllerRoleForTrackedDeviceIndex(i) == role) {
+      return i;
+    }
+  }
+  return vr::k_unTrackedDeviceIndexInvalid;
+}
+vr::ETrackedControllerRole stub_runtime::system_interface::GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t device_index) {
+  /// The first controller is the left hand and the second the right, any others have no role - or as recorded, when replaying
+  if(!parent.is_controller(device_index)) {
+    return vr::TrackedControllerRole_Invalid;
+  }
+  if(parent.replay) {
+    return static_cast<vr::ETrackedControllerRole>(parent.replay->get_devices().roles[device_index]);
+  }
+  switch(device_index) {
+  case 1:
+    return vr::TrackedControllerRole_LeftHand;
+  case 2:
+    return vr::TrackedControllerRole_RightHand;
+  default:
+    return vr::TrackedControllerRole_Invalid;
+  }
+}
+vr::ETrackedDeviceClass stub_runtime::system_interface::GetTrackedDeviceClass(vr::TrackedDeviceIndex_t device_index) {
+  /// Device zero is the HMD, followed by the controllers - or as recorded, when replaying
+  if(parent.replay && device_index < vr::k_unMaxTrackedDeviceCount) {
+    return static_cast<vr::ETrackedDeviceClass>(parent.replay->get_devices().device_classes[device_index]);
+  }
+  if(device_index == vr::k_unTrackedDeviceIndex_Hmd) {
+    return vr::TrackedDeviceClass_HMD;
+  }
+  return parent.is_controller(device_index) ? vr::TrackedDeviceClass_Controller : vr::TrackedDeviceClass_Invalid;
+}
+bool stub_runtime::system_interface::IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t device_index) {
+  /// Whether this is the HMD or one of the configured controllers
+  return parent.is_connected(device_index);
+}
+bool stub_runtime::system_interface::GetBoolTrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index,
+                                                                  vr::ETrackedDeviceProperty prop [[maybe_unused]],
+                                                                  vr::ETrackedPropertyError *error) {
+  /// No boolean properties are provided
+  set_error(error, parent.is_connected(device_index) ? vr::TrackedProp_UnknownProperty : vr::TrackedProp_InvalidDevice);
+  return false;
+}
+float stub_runtime::system_interface::GetFloatTrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index,
+                                                                    vr::ETrackedDeviceProperty prop,
+                                                                    vr::ETrackedPropertyError *error) {
+  /// Provide the display timing and IPD of the HMD
+  if(!parent.is_connected(device_index)) {
+    set_error(error, vr::TrackedProp_InvalidDevice);
+    return 0.0f;
+  }
+  if(device_index == vr::k_unTrackedDeviceIndex_Hmd) {
+    switch(prop) {
+    case vr::Prop_DisplayFrequency_Float:
+      set_error(error, vr::TrackedProp_Success);
+      return parent.frame_rate;
+    case vr::Prop_SecondsFromVsyncToPhotons_Float:
+      set_error(error, vr::TrackedProp_Success);
+      return parent.replay ? parent.replay->get_devices().vsync_to_photon_time : 0.011f;
+    case vr::Prop_UserIpdMeters_Float:
+      set_error(error, vr::TrackedProp_Success);
+      return parent.replay ? parent.replay->get_devices().user_ipd : 0.064f;
+    default:
+      break;
+    }
+  }
+  set_error(error, vr::TrackedProp_UnknownProperty);
+  return 0.0f;
+}
+int32_t stub_runtime::system_interface::GetInt32TrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index,
+                                                                      vr::ETrackedDeviceProperty prop,
+                                                                      vr::ETrackedPropertyError *error) {
+  /// Provide the device class, and each controller's axis types - a trackpad then a trigger
+  if(!parent.is_connected(device_index)) {
+    set_error(error, vr::TrackedProp_InvalidDevice);
+    return 0;
+  }
+  if(prop == vr::Prop_DeviceClass_Int32) {
+    set_error(error, vr::TrackedProp_Success);
+    return GetTrackedDeviceClass(device_index);
+  }
+  if(parent.is_controller(device_index) && prop >= vr::Prop_Axis0Type_Int32 && prop <= vr::Prop_Axis4Type_Int32) {
+    set_error(error, vr::TrackedProp_Success);
+    switch(prop) {
+    case vr::Prop_Axis0Type_Int32:
+      return vr::k_eControllerAxis_TrackPad;
+    case vr::Prop_Axis1Type_Int32:
+      return vr::k_eControllerAxis_Trigger;
+    default:
+      return vr::k_eControllerAxis_None;
+    }
+  }
+  set_error(error, vr::TrackedProp_UnknownProperty);
+  return 0;
+}
+uint64_t stub_runtime::system_interface::GetUint64TrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index,
+                                                                        vr::ETrackedDeviceProperty prop,
+                                                                        vr::ETrackedPropertyError *error) {
+  /// Provide each controller's supported buttons
+  if(!parent.is_connected(device_index)) {
+    set_error(error, vr::TrackedProp_InvalidDevice);
+    return 0;
+  }
+  if(parent.is_controller(device_index) && prop == vr::Prop_SupportedButtons_Uint64) {
+    set_error(error, vr::TrackedProp_Success);
+    uint64_t buttons = button_mask(vr::k_EButton_System);
+    for(auto const &it : stub_buttons) {
+      buttons |= button_mask(it);
+    }
+    return buttons;
+  }
+  set_error(error, vr::TrackedProp_UnknownProperty);
+  return 0;
+}
+vr::HmdMatrix34_t stub_runtime::system_interface::GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index,
+                                                                                   vr::ETrackedDeviceProperty prop [[maybe_unused]],
+                                                                                   vr::ETrackedPropertyError *error) {
+  /// No matrix properties are provided
+  set_error(error, parent.is_connected(device_index) ? vr::TrackedProp_UnknownProperty : vr::TrackedProp_InvalidDevice);
+  return identity_matrix34();
+}
+uint32_t stub_runtime::system_interface::GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index,
+                                                                        vr::ETrackedDeviceProperty prop,
+                                                                        char *value,
+                                                                        uint32_t buffer_size,
+                                                                        vr::ETrackedPropertyError *error) {
+  /// Provide identifying strings, returning the length including the terminator even if the buffer is too small
+  if(!parent.is_connected(device_index)) {
+    set_error(error, vr::TrackedProp_InvalidDevice);
+    return 0;
+  }
+  bool const hmd = device_index == vr::k_unTrackedDeviceIndex_Hmd;
+  std::string result;
+  switch(prop) {
+  case vr::Prop_TrackingSystemName_String:
+    result = "vrstorm_stub";
+    break;
+  case vr::Prop_ManufacturerName_String:
+    result = "VRStorm";
+    break;
+  case vr::Prop_ModelNumber_String:
+    result = hmd ? "Stub HMD" : "Stub Controller";
+    break;
+  case vr::Prop_SerialNumber_String:
+    result = "STUB-" + std::to_string(device_index);
+    break;
+  case vr::Prop_RenderModelName_String:
+    result = hmd ? "vrstorm_stub_hmd" : "vrstorm_stub_controller";
+    break;
+  default:
+    set_error(error, vr::TrackedProp_UnknownProperty);
+    return 0;
+  }
+  uint32_t const length = static_cast<uint32_t>(result.size() + 1);
+  if(!value || buffer_size < length) {
+    set_error(error, vr::TrackedProp_BufferTooSmall);
+    return length;
+  }
+  std::memcpy(value, result.c_str(), length);
+  set_error(error, vr::TrackedProp_Success);
+  return length;
+}
+char const *stub_runtime::system_interface::GetPropErrorNameFromEnum(vr::ETrackedPropertyError error) {
+  /// Name the property errors the stub can report
+  switch(error) {
+  case vr::TrackedProp_Success:
+    return "TrackedProp_Success";
+  case vr::TrackedProp_UnknownProperty:
+    return "TrackedProp_UnknownProperty";
+  case vr::TrackedProp_InvalidDevice:
+    return "TrackedProp_InvalidDevice";
+  case vr::TrackedProp_BufferTooSmall:
+    return "TrackedProp_BufferTooSmall";
+  default:
+    return "Unknown property error";
+  }
+}
+bool stub_runtime::system_interface::PollNextEvent(vr::VREvent_t *event, uint32_t event_size) {
+  /// Return the next synthetic event due by the current frame, if any
+  if(event_size < sizeof(vr::VREvent_t)) {
+    return false;
+  }
+  return parent.fill_next_event(*event);
+}
+bool stub_runtime::system_interface::PollNextEventWithPose(vr::ETrackingUniverseOrigin origin [[maybe_unused]],
+                                                           vr::VREvent_t *event,
+                                                           uint32_t event_size,
+                                                           vr::TrackedDevicePose_t *pose) {
+  /// Return the next synthetic event, with the pose of the device it came from
+  if(!PollNextEvent(event, event_size)) {
+    return false;
+  }
+  if(pose) {
+    parent.fill_pose(event->trackedDeviceIndex, parent.get_time(), *pose);
+  }
+  return true;
+}
+char const *stub_runtime::system_interface::GetEventTypeNameFromEnum(vr::EVREventType type) {
+  /// Name the event types the stub generates
+  switch(type) {
+  case vr::VREvent_ButtonPress:
+    return "VREvent_ButtonPress";
+  case vr::VREvent_ButtonUnpress:
+    return "VREvent_ButtonUnpress";
+  default:
+    return "Unknown event";
+  }
+}
+vr::HiddenAreaMesh_t stub_runtime::system_interface::GetHiddenAreaMesh(vr::EVREye eye [[maybe_unused]]) {
+  /// There is no hidden area
+  return {nullptr, 0};
+}
+bool stub_runtime::system_interface::GetControllerState(vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t *state) {
+  /// Report the synthetic state of a controller at the current frame
+  if(!parent.is_controller(device_index)) {
+    return false;
+  }
+  parent.fill_controller_state(device_index, *state);
+  return true;
+}
+bool stub_runtime::system_interface::GetControllerStateWithPose(vr::ETrackingUniverseOrigin origin [[maybe_unused]],
+                                                                vr::TrackedDeviceIndex_t device_index,
+                                                                vr::VRControllerState_t *state,
+                                                                vr::TrackedDevicePose_t *pose) {
+  /// Report the synthetic state of a controller at the current frame, with its pose
+  if(!GetControllerState(device_index, state)) {
+    return false;
+  }
+  if(pose) {
+    parent.fill_pose(device_index, parent.get_time(), *pose);
+  }
+  return true;
+}
+void stub_runtime::system_interface::TriggerHapticPulse(vr::TrackedDeviceIndex_t device_index [[maybe_unused]],
+                                                        uint32_t axis [[maybe_unused]],
+                                                        unsigned short duration_microseconds [[maybe_unused]]) {
+  /// There is nothing to vibrate
+}
+char const *stub_runtime::system_interface::GetButtonIdNameFromEnum(vr::EVRButtonId button) {
+  /// Name the buttons the stub reports
+  switch(button) {
+  case vr::k_EButton_System:
+    return "k_EButton_System";
+  case vr::k_EButton_ApplicationMenu:
+    return "k_EButton_ApplicationMenu";
+  case vr::k_EButton_Grip:
+    return "k_EButton_Grip";
+  case vr::k_EButton_SteamVR_Touchpad:
+    return "k_EButton_SteamVR_Touchpad";
+  case vr::k_EButton_SteamVR_Trigger:
+    return "k_EButton_SteamVR_Trigger";
+  default:
+    return "Unknown button";
+  }
+}
+char const *stub_runtime::system_interface::GetControllerAxisTypeNameFromEnum(vr::EVRControllerAxisType axis_type) {
+  /// Name the axis types the stub reports
+  switch(axis_type) {
+  case vr::k_eControllerAxis_None:
+    return "k_eControllerAxis_None";
+  case vr::k_eControllerAxis_TrackPad:
+    return "k_eControllerAxis_TrackPad";
+  case vr::k_eControllerAxis_Trigger:
+    return "k_eControllerAxis_Trigger";
+  default:
+    return "Unknown axis type";
+  }
+}
+bool stub_runtime::system_interface::CaptureInputFocus() {
+  /// Input focus is always ours
+  return true;
+}
+void stub_runtime::system_interface::ReleaseInputFocus() {
+  /// Input focus is always ours
+}
+bool stub_runtime::system_interface::IsInputFocusCapturedByAnotherProcess() {
+  /// Input focus is always ours
+  return false;
+}
+uint32_t stub_runtime::system_interface::DriverDebugRequest(vr::TrackedDeviceIndex_t device_index [[maybe_unused]],
+                                                            char const *request [[maybe_unused]],
+                                                            char *response,
+                                                            uint32_t response_size) {
+  /// There is no driver, so every response is empty
+  if(response && response_size != 0) {
+    response[0] = '\0';
+  }
+  return 0;
+}
+vr::EVRFirmwareError stub_runtime::system_interface::PerformFirmwareUpdate(vr::TrackedDeviceIndex_t device_index [[maybe_unused]]) {
+  /// There is no firmware
+  return vr::VRFirmwareError_None;
+}
+void stub_runtime::system_interface::AcknowledgeQuit_Exiting() {
+  /// The stub never asks the application to quit
+}
+void stub_runtime::system_interface::AcknowledgeQuit_UserPrompt() {
+  /// The stub never asks the application to quit
+}
+
+stub_runtime::compositor_interface::compositor_interface(stub_runtime &this_parent)
+  : parent(this_parent) {
+  /// Default constructor
+}
+
+void stub_runtime::compositor_interface::SetTrackingSpace(vr::ETrackingUniverseOrigin origin) {
+  /// Remember the tracking space, which doesn't change the synthetic poses
+  parent.tracking_space = origin;
+}
+vr::ETrackingUniverseOrigin stub_runtime::compositor_interface::GetTrackingSpace() {
+  /// Return the tracking space last set
+  return parent.tracking_space;
+}
+vr::EVRCompositorError stub_runtime::compositor_interface::WaitGetPoses(vr::TrackedDevicePose_t *render_poses,
+                                                                        uint32_t render_pose_count,
+                                                                        vr::TrackedDevicePose_t *game_poses,
+                                                                        uint32_t game_pose_count) {
+  /// Wait for the next frame if paced, otherwise advance to it immediately, and return its poses
+  if(parent.replay) {
+    if(parent.paced) {                                                          // the manager advances replayed frames, so just wait for this one's recorded time
+      double const offset = parent.get_replay_frame().time - parent.replay->get_frame(0).time;
+      std::this_thread::sleep_until(parent.start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(offset)));
+    }
+    if(parent.fill_replay_render_poses(render_poses, render_pose_count)) {     // rendered with different poses from the ones update() read
+      parent.fill_poses(parent.get_time() + 1.0 / parent.frame_rate, game_poses, game_pose_count);
+      return vr::VRCompositorError_None;
+    }
+  } else if(parent.paced) {
+    uint64_t const next_frame = parent.get_frame() + 1;
+    std::this_thread::sleep_until(parent.start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(static_cast<double>(next_frame) / parent.frame_rate)));
+  } else {
+    parent.advance();
+  }
+  return GetLastPoses(render_poses, render_pose_count, game_poses, game_pose_count);
+}
+vr::EVRCompositorError stub_runtime::compositor_interface::GetLastPoses(vr::TrackedDevicePose_t *render_poses,
+                                                                        uint32_t render_pose_count,
+                                                                        vr::TrackedDevicePose_t *game_poses,
+                                                                        uint32_t game_pose_count) {
+  /// Return the poses for the current frame, and one frame later for game logic
+  double const time = parent.get_time();
+  parent.fill_poses(time, render_poses, render_pose_count);
+  parent.fill_poses(time + 1.0 / parent.frame_rate, game_poses, game_pose_count);
+  return vr::VRCompositorError_None;
+}
+vr::EVRCompositorError stub_runtime::compositor_interface::GetLastPoseForTrackedDeviceIndex(vr::TrackedDeviceIndex_t device_index,
+                                                                                            vr::TrackedDevicePose_t *render_pose,
+                                                                                            vr::TrackedDevicePose_t *game_pose) {
+  /// Return one device's poses for the current frame
+  double const time = parent.get_time();
+  if(render_pose) {
+    parent.fill_pose(device_index, time, *render_pose);
+  }
+  if(game_pose) {
+    parent.fill_pose(device_index, time + 1.0 / parent.frame_rate, *game_pose);
+  }
+  return vr::VRCompositorError_None;
+}
+vr::EVRCompositorError stub_runtime::compositor_interface::Submit(vr::EVREye eye [[maybe_unused]],
+                                                                  vr::Texture_t const *texture [[maybe_unused]],
+                                                                  vr::VRTextureBounds_t const *bounds [[maybe_unused]],
+                                                                  vr::EVRSubmitFlags flags [[maybe_unused]]) {
+  /// Accept and discard a submitted eye texture
+  return vr::VRCompositorError_None;
+}
+void stub_runtime::compositor_interface::ClearLastSubmittedFrame() {
+  /// Nothing is kept from submitted frames
+}
+void stub_runtime::compositor_interface::PostPresentHandoff() {
+  /// There is no compositor work to start
+}
+bool stub_runtime::compositor_interface::GetFrameTiming(vr::Compositor_FrameTiming *timing, uint32_t frames_ago) {
+  /// Report a frame that used half the GPU budget and was never dropped
+  if(timing->m_nSize != sizeof(vr::Compositor_FrameTiming)) {
+    return false;
+  }
+  uint64_t const frame = parent.get_frame();
+  if(frames_ago > frame) {
+    return false;
+  }
+  float const frame_ms = 1000.0f / parent.frame_rate;
+  std::memset(timing, 0, sizeof(vr::Compositor_FrameTiming));
+  timing->m_nSize                    = sizeof(vr::Compositor_FrameTiming);
+  timing->m_nFrameIndex              = static_cast<uint32_t>(frame - frames_ago);
+  timing->m_nNumFramePresents        = 1;
+  timing->m_flSystemTimeInSeconds    = static_cast<double>(frame - frames_ago) / parent.frame_rate;
+  timing->m_flSceneRenderGpuMs       = frame_ms * 0.5f;
+  timing->m_flTotalRenderGpuMs       = frame_ms * 0.5f;
+  timing->m_flClientFrameIntervalMs  = frame_ms;
+  parent.fill_pose(vr::k_unTrackedDeviceIndex_Hmd, timing->m_flSystemTimeInSeconds, timing->m_HmdPose);
+  return true;
+}
+float stub_runtime::compositor_interface::GetFrameTimeRemaining() {
+  /// Report the time until the next frame is due, which is always zero when not paced
+  if(!parent.paced) {
+    return 0.0f;
+  }
+  float const frame_seconds = 1.0f / parent.frame_rate;
+  float const elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - parent.start_time).count();
+  return frame_seconds - std::fmod(elapsed, frame_seconds);
+}
+void stub_runtime::compositor_interface::GetCumulativeStats(vr::Compositor_CumulativeStats *stats, uint32_t stats_size) {
+  /// Report every frame so far as presented, with none dropped or reprojected
+  if(stats_size != sizeof(vr::Compositor_CumulativeStats)) {
+    return;
+  }
+  std::memset(stats, 0, sizeof(vr::Compositor_CumulativeStats));
+  stats->m_nNumFramePresents = static_cast<uint32_t>(parent.get_frame());
+}
+void stub_runtime::compositor_interface::FadeToColor(float seconds [[maybe_unused]],
+                                                     float red [[maybe_unused]],
+                                                     float green [[maybe_unused]],
+                                                     float blue [[maybe_unused]],
+                                                     float alpha [[maybe_unused]],
+                                                     bool background [[maybe_unused]]) {
+  /// There is no display to fade
+}
+void stub_runtime::compositor_interface::FadeGrid(float seconds [[maybe_unused]], bool fade_in [[maybe_unused]]) {
+  /// There is no display to fade
+}
+vr::EVRCompositorError stub_runtime::compositor_interface::SetSkyboxOverride(vr::Texture_t const *textures [[maybe_unused]],
+                                                                             uint32_t texture_count [[maybe_unused]]) {
+  /// Accept and discard a skybox
+  return vr::VRCompositorError_None;
+}
+void stub_runtime::compositor_interface::ClearSkyboxOverride() {
+  /// There is no skybox
+}
+void stub_runtime::compositor_interface::CompositorBringToFront() {
+  /// There is no compositor window
+}
+void stub_runtime::compositor_interface::CompositorGoToBack() {
+  /// There is no compositor window
+}
+void stub_runtime::compositor_interface::CompositorQuit() {
+  /// There is no compositor process
+}
+bool stub_runtime::compositor_interface::IsFullscreen() {
+  /// There is no compositor window
+  return false;
+}
+uint32_t stub_runtime::compositor_interface::GetCurrentSceneFocusProcess() {
+  /// There are no other processes
+  return 0;
+}
+uint32_t stub_runtime::compositor_interface::GetLastFrameRenderer() {
+  /// There are no other processes
+  return 0;
+}
+bool stub_runtime::compositor_interface::CanRenderScene() {
+  /// Rendering is always allowed
+  return true;
+}
+void stub_runtime::compositor_interface::ShowMirrorWindow() {
+  /// There is no mirror window
+}
+void stub_runtime::compositor_interface::HideMirrorWindow() {
+  /// There is no mirror window
+}
+bool stub_runtime::compositor_interface::IsMirrorWindowVisible() {
+  /// There is no mirror window
+  return false;
+}
+void stub_runtime::compositor_interface::CompositorDumpImages() {
+  /// There are no images to dump
+}
+bool stub_runtime::compositor_interface::ShouldAppRenderWithLowResources() {
+  /// Nothing else competes for resources
+  return false;
+}
+void stub_runtime::compositor_interface::ForceInterleavedReprojectionOn(bool override_reprojection [[maybe_unused]]) {
+  /// There is no reprojection
+}
+void stub_runtime::compositor_interface::ForceReconnectProcess() {
+  /// There is no compositor process
+}
+void stub_runtime::compositor_interface::SuspendRendering(bool suspend [[maybe_unused]]) {
+  /// There is no rendering to suspend
+}
+
+void stub_runtime::load(openvr_symbols &symbols, session_replay const *this_replay) {
+  /// Point the runtime entry points at this stub and restart its synthetic time, in place of loading the OpenVR library
+  active = this;
+  replay = this_replay;
+  replay_event_frame = 0;
+  replay_event_index = 0;
+  replay_pose_frame = std::numeric_limits<uint64_t>::max();
+  if(replay && replay->get_devices().display_frequency > 0.0f) {
+    frame_rate = replay->get_devices().display_frequency;
+  }
+  start_time = std::chrono::steady_clock::now();
+  frame.store(0, std::memory_order_relaxed);
+  events_sent.store(0, std::memory_order_relaxed);
+  tracking_space = vr::TrackingUniverseStanding;
+  controllers = std::min(controllers, vr::k_unMaxTrackedDeviceCount - 1);
+
+  symbols.VR_IsRuntimeInstalled                 = &is_runtime_installed;
+  symbols.VR_RuntimePath                        = &runtime_path;
+  symbols.VR_IsHmdPresent                       = &is_hmd_present;
+  symbols.VR_InitInternal                       = &init_internal;
+  symbols.VR_ShutdownInternal                   = &shutdown_internal;
+  symbols.VR_IsInterfaceVersionValid            = &is_interface_version_valid;
+  symbols.VR_GetVRInitErrorAsEnglishDescription = &get_init_error_description;
+  symbols.VR_GetGenericInterface                = &get_generic_interface;
+  symbols.VR_GetInitToken                       = &get_init_token;
+}
+
+void stub_runtime::advance(uint64_t frames) {
+  /// Move synthetic time forward, when not paced or when replaying - lets a harness step frames without calling WaitGetPoses
+  frame.fetch_add(frames, std::memory_order_relaxed);
+}
+
+uint64_t stub_runtime::get_frame() const {
+  /// Return the current frame number, from the clock if paced and not replaying
+  if(!paced || replay) {
+    return frame.load(std::memory_order_relaxed);
+  }
+  double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  return static_cast<uint64_t>(elapsed * frame_rate);
+}
+double stub_runtime::get_time() const {
+  /// Return the synthetic time of the current frame, in seconds since the stub was loaded
+  return static_cast<double>(get_frame()) / frame_rate;
+}
+
+bool stub_runtime::is_controller(vr::TrackedDeviceIndex_t device_index) const {
+  /// Controllers take the device indices after the HMD, unless replaying a recording
+  if(replay) {
+    return device_index < vr::k_unMaxTrackedDeviceCount && replay->get_devices().device_classes[device_index] == vr::TrackedDeviceClass_Controller;
+  }
+  return device_index != vr::k_unTrackedDeviceIndex_Hmd && device_index <= controllers;
+}
+bool stub_runtime::is_connected(vr::TrackedDeviceIndex_t device_index) const {
+  /// Whether this is the HMD or one of the controllers, or any device that was recorded
+  if(replay) {
+    return device_index < vr::k_unMaxTrackedDeviceCount && replay->get_devices().device_classes[device_index] != vr::TrackedDeviceClass_Invalid;
+  }
+  return device_index == vr::k_unTrackedDeviceIndex_Hmd || is_controller(device_index);
+}
+uint64_t stub_runtime::get_events_due() const {
+  /// Return how many events should have been sent by the current frame
+  return static_cast<uint64_t>(static_cast<double>(get_frame()) * event_rate / frame_rate);
+}
+uint64_t stub_runtime::get_buttons_pressed(vr::TrackedDeviceIndex_t device_index) const {
+  /// Derive which buttons a controller is holding from the events sent so far - an odd count means the last press is still held
+  uint64_t const sent = events_sent.load(std::memory_order_relaxed);
+  if(controllers == 0 || sent % 2 == 0) {
+    return 0;
+  }
+  uint64_t const pair = sent / 2;                                               // each press is followed by its unpress
+  if(pair % controllers + 1 != device_index) {
+    return 0;
+  }
+  return button_mask(stub_buttons[(pair / controllers) % stub_buttons.size()]);
+}
+session_log_frame const &stub_runtime::get_replay_frame() const {
+  /// Return the recorded frame being replayed - the first advance moves onto the first frame, so it's held until then too
+  uint64_t const this_frame = get_frame();
+  return replay->get_frame(this_frame == 0 ? 0 : this_frame - 1);
+}
+
+void stub_runtime::fill_pose(vr::TrackedDeviceIndex_t device_index, double time, vr::TrackedDevicePose_t &pose) const {
+  /// Sample one device's synthetic motion - the HMD sways gently, the controllers move in slow loops in front of it
+  if(replay && device_index < vr::k_unMaxTrackedDeviceCount) {
+    pose = get_replay_frame().poses[device_index];                              // recorded poses were already predicted, so the time is ignored
+    return;
+  }
+  if(!is_connected(device_index)) {
+    pose.mDeviceToAbsoluteTracking = identity_matrix34();
+    pose.vVelocity        = {{0.0f, 0.0f, 0.0f}};
+    pose.vAngularVelocity = {{0.0f, 0.0f, 0.0f}};
+    pose.eTrackingResult = vr::TrackingResult_Uninitialized;
+    pose.bPoseIsValid = false;
+    pose.bDeviceIsConnected = false;
+    return;
+  }
+  auto const sample = [device_index](double t, float &yaw, float &x, float &y, float &z){
+    if(device_index == vr::k_unTrackedDeviceIndex_Hmd) {
+      yaw = static_cast<float>(0.3 * std::sin(0.25 * t));
+      x   = static_cast<float>(0.05 * std::sin(0.5 * t));
+      y   = static_cast<float>(1.7 + 0.02 * std::sin(1.3 * t));
+      z   = static_cast<float>(0.05 * std::cos(0.5 * t));
+    } else {
+      double const phase = device_index;                                        // so controllers don't move in lockstep
+      double const side = device_index % 2 == 1 ? -1.0 : 1.0;                   // odd devices on the left, even on the right
+      double const row = (device_index - 1) / 2;                                // further controllers stand further forward
+      yaw = static_cast<float>(0.5 * std::sin(0.7 * t + phase));
+      x   = static_cast<float>(side * 0.3 + 0.1 * std::cos(t + phase));
+      y   = static_cast<float>(1.2 + 0.1 * std::sin(t + phase));
+      z   = static_cast<float>(-0.3 - 0.2 * row + 0.05 * std::sin(2.0 * t + phase));
+    }
+  };
+  double constexpr step = 0.001;                                                // velocities are taken from the motion either side
+  float yaw, x, y, z;
+  float yaw0, x0, y0, z0;
+  float yaw1, x1, y1, z1;
+  sample(time,        yaw,  x,  y,  z);
+  sample(time - step, yaw0, x0, y0, z0);
+  sample(time + step, yaw1, x1, y1, z1);
+  float constexpr scale = static_cast<float>(0.5 / step);
+  pose.mDeviceToAbsoluteTracking = yaw_matrix34(yaw, x, y, z);
+  pose.vVelocity        = {{(x1 - x0) * scale, (y1 - y0) * scale, (z1 - z0) * scale}};
+  pose.vAngularVelocity = {{0.0f, (yaw1 - yaw0) * scale, 0.0f}};
+  pose.eTrackingResult = vr::TrackingResult_Running_OK;
+  pose.bPoseIsValid = true;
+  pose.bDeviceIsConnected = true;
+}
+void stub_runtime::fill_poses(double time, vr::TrackedDevicePose_t *poses, uint32_t pose_count) const {
+  /// Sample the motion of every device into a pose array
+  if(!poses) {
+    return;
+  }
+  for(uint32_t i = 0; i != pose_count; ++i) {
+    fill_pose(i, time, poses[i]);
+  }
+}
+bool stub_runtime::fill_replay_render_poses(vr::TrackedDevicePose_t *poses, uint32_t pose_count) {
+  /// When replaying, serve reads after each frame's first - wait_for_frame() or late_latch() - from the poses recorded as rendered with; returns false to fill them as usual
+  if(!replay) {
+    return false;
+  }
+  uint64_t const this_frame = get_frame();
+  if(replay_pose_frame != this_frame) {
+    replay_pose_frame = this_frame;                                             // the first read is update()'s, recorded as the frame's poses
+    return false;
+  }
+  session_log_frame const &this_replay_frame = get_replay_frame();
+  if(!this_replay_frame.render_poses_recorded || !poses) {
+    return false;
+  }
+  std::copy_n(this_replay_frame.render_poses.begin(), std::min(pose_count, vr::k_unMaxTrackedDeviceCount), poses);
+  return true;
+}
+void stub_runtime::fill_controller_state(vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t &state) const {
+  /// Sample a controller's buttons and axes - a thumb circling the trackpad and a trigger squeezing in and out
+  if(replay) {
+    session_log_frame const &this_frame = get_replay_frame();
+    if((this_frame.controller_mask >> device_index) & 1) {
+      state = this_frame.controller_states[device_index];
+    } else {
+      std::memset(&state, 0, sizeof(state));                                    // this controller wasn't polled when recording
+    }
+    return;
+  }
+  uint64_t const this_frame = get_frame();
+  double const time = static_cast<double>(this_frame) / frame_rate;
+  double const phase = device_index;
+  std::memset(&state, 0, sizeof(state));
+  state.unPacketNum = static_cast<uint32_t>(this_frame);                        // changes only when time moves
+  state.ulButtonPressed = get_buttons_pressed(device_index);
+  state.ulButtonTouched = state.ulButtonPressed | button_mask(vr::k_EButton_SteamVR_Touchpad);
+  state.rAxis[0].x = static_cast<float>(0.8 * std::cos(2.0 * time + phase));
+  state.rAxis[0].y = static_cast<float>(0.8 * std::sin(2.0 * time + phase));
+  state.rAxis[1].x = static_cast<float>(0.5 + 0.5 * std::sin(3.0 * time + phase));
+}
+bool stub_runtime::fill_next_event(vr::VREvent_t &event) {
+  /// Fill in the next event if one is due - presses and unpresses alternate, cycling through the controllers and then the buttons
+  if(replay) {
+    uint64_t const this_frame = get_frame();
+    if(this_frame != replay_event_frame) {                                      // a new frame, so start on its events
+      replay_event_frame = this_frame;
+      replay_event_index = 0;
+    }
+    session_log_frame const &recorded = get_replay_frame();
+    if(this_frame == 0 || replay_event_index == recorded.event_count) {         // nothing is replayed before the first frame
+      return false;
+    }
+    event = recorded.events[replay_event_index];
+    ++replay_event_index;
+    return true;
+  }
+  uint64_t const sent = events_sent.load(std::memory_order_relaxed);
+  if(controllers == 0 || sent >= get_events_due()) {
+    return false;
+  }
+  uint64_t const pair = sent / 2;
+  std::memset(&event, 0, sizeof(event));
+  event.eventType = sent % 2 == 0 ? vr::VREvent_ButtonPress : vr::VREvent_ButtonUnpress;
+  event.trackedDeviceIndex = static_cast<vr::TrackedDeviceIndex_t>(pair % controllers + 1);
+  event.eventAgeSeconds = 0.0f;
+  event.data.controller.button = stub_buttons[(pair / controllers) % stub_buttons.size()];
+  events_sent.store(sent + 1, std::memory_order_relaxed);                       // only the polling thread sends events
+  return true;
+}
+
+bool stub_runtime::is_runtime_installed() {
+  /// The stub is always available
+  return true;
+}
+char const *stub_runtime::runtime_path() {
+  /// There is no installation to point to
+  return "(built-in stub runtime)";
+}
+bool stub_runtime::is_hmd_present() {
+  /// The stub always provides an HMD
+  return true;
+}
+uint32_t stub_runtime::init_internal(vr::EVRInitError *error, vr::EVRApplicationType application_type [[maybe_unused]]) {
+  /// Initialisation always succeeds
+  *error = active ? vr::VRInitError_None : vr::VRInitError_Init_InterfaceNotFound;
+  return stub_init_token;
+}
+void stub_runtime::shutdown_internal() {
+  /// Detach the entry points from the stub
+  active = nullptr;
+}
+bool stub_runtime::is_interface_version_valid(char const *version) {
+  /// Only the system and compositor interfaces are provided
+  return std::strcmp(version, vr::IVRSystem_Version) == 0 || std::strcmp(version, vr::IVRCompositor_Version) == 0;
+}
+char const *stub_runtime::get_init_error_description(vr::EVRInitError error) {
+  /// Describe the errors the stub can report
+  switch(error) {
+  case vr::VRInitError_None:
+    return "No error";
+  case vr::VRInitError_Init_InterfaceNotFound:
+    return "Interface not provided by the stub runtime";
+  default:
+    return "Unknown error";
+  }
+}
+void *stub_runtime::get_generic_interface(char const *version, vr::EVRInitError *error) {
+  /// Return the stub's system or compositor interface - anything else, such as render models or the chaperone, is unavailable
+  if(active) {
+    if(std::strcmp(version, vr::IVRSystem_Version) == 0) {
+      *error = vr::VRInitError_None;
+      return static_cast<vr::IVRSystem*>(&active->system);
+    }
+    if(std::strcmp(version, vr::IVRCompositor_Version) == 0) {
+      *error = vr::VRInitError_None;
+      return static_cast<vr::IVRCompositor*>(&active->compositor);
+    }
+  }
+  *error = vr::VRInitError_Init_InterfaceNotFound;
+  return nullptr;
+}
+uint32_t stub_runtime::get_init_token() {
+  /// Matches the token returned by init, so the context is never cleared again
+  return stub_init_token;
+}
+
+}
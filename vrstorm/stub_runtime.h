@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+#include "openvr_symbols.h"
+#include "session_log.h"
+
+namespace vrstorm {
+
+class stub_runtime {
+  /// In-process stand-in for the OpenVR runtime, generating synthetic poses, controller states and events without a headset
+public:
+  float frame_rate = 90.0f;                                                     // frames per second of synthetic time, also reported as the display frequency
+  float event_rate = 10.0f;                                                     // button events per second, spread across all controllers
+  unsigned int controllers = 2;                                                 // the first takes the left hand role and the second the right
+  bool paced = true;                                                            // WaitGetPoses sleeps until the next frame is due, or until its recorded time when replaying
+
+private:
+  class system_interface : public vr::IVRSystem {
+    /// Synthetic implementation of the system interface, IVRSystem_012
+    stub_runtime &parent;
+
+  public:
+    explicit system_interface(stub_runtime &this_parent);
+
+    void GetRecommendedRenderTargetSize(uint32_t *width, uint32_t *height) override;
+    vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eye, float near_z, float far_z, vr::EGraphicsAPIConvention convention) override;
+    void GetProjectionRaw(vr::EVREye eye, float *left, float *right, float *top, float *bottom) override;
+    vr::DistortionCoordinates_t ComputeDistortion(vr::EVREye eye, float u, float v) override;
+    vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eye) override;
+    bool GetTimeSinceLastVsync(float *seconds_since_vsync, uint64_t *frame_counter) override;
+    int32_t GetD3D9AdapterIndex() override;
+    void GetDXGIOutputInfo(int32_t *adapter_index) override;
+    bool IsDisplayOnDesktop() override;
+    bool SetDisplayVisibility(bool visible_on_desktop) override;
+    void GetDeviceToAbsoluteTrackingPose(vr::ETrackingUniverseOrigin origin, float predicted_seconds, vr::TrackedDevicePose_t *poses, uint32_t pose_count) override;
+    void ResetSeatedZeroPose() override;
+    vr::HmdMatrix34_t GetSeatedZeroPoseToStandingAbsoluteTrackingPose() override;
+    vr::HmdMatrix34_t GetRawZeroPoseToStandingAbsoluteTrackingPose() override;
+    uint32_t GetSortedTrackedDeviceIndicesOfClass(vr::ETrackedDeviceClass device_class, vr::TrackedDeviceIndex_t *indices, uint32_t index_count, vr::TrackedDeviceIndex_t relative_to) override;
+    vr::EDeviceActivityLevel GetTrackedDeviceActivityLevel(vr::TrackedDeviceIndex_t device_index) override;
+    void ApplyTransform(vr::TrackedDevicePose_t *output_pose, vr::TrackedDevicePose_t const *pose, vr::HmdMatrix34_t const *transform) override;
+    vr::TrackedDeviceIndex_t GetTrackedDeviceIndexForControllerRole(vr::ETrackedControllerRole role) override;
+    vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t device_index) override;
+    vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t device_index) override;
+    bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t device_index) override;
+    bool GetBoolTrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *error) override;
+    float GetFloatTrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *error) override;
+    int32_t GetInt32TrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *error) override;
+    uint64_t GetUint64TrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *error) override;
+    vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *error) override;
+    uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t device_index, vr::ETrackedDeviceProperty prop, char *value, uint32_t buffer_size, vr::ETrackedPropertyError *error) override;
+    char const *GetPropErrorNameFromEnum(vr::ETrackedPropertyError error) override;
+    bool PollNextEvent(vr::VREvent_t *event, uint32_t event_size) override;
+    bool PollNextEventWithPose(vr::ETrackingUniverseOrigin origin, vr::VREvent_t *event, uint32_t event_size, vr::TrackedDevicePose_t *pose) override;
+    char const *GetEventTypeNameFromEnum(vr::EVREventType type) override;
+    vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye eye) override;
+    bool GetControllerState(vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t *state) override;
+    bool GetControllerStateWithPose(vr::ETrackingUniverseOrigin origin, vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t *state, vr::TrackedDevicePose_t *pose) override;
+    void TriggerHapticPulse(vr::TrackedDeviceIndex_t device_index, uint32_t axis, unsigned short duration_microseconds) override;
+    char const *GetButtonIdNameFromEnum(vr::EVRButtonId button) override;
+    char const *GetControllerAxisTypeNameFromEnum(vr::EVRControllerAxisType axis_type) override;
+    bool CaptureInputFocus() override;
+    void ReleaseInputFocus() override;
+    bool IsInputFocusCapturedByAnotherProcess() override;
+    uint32_t DriverDebugRequest(vr::TrackedDeviceIndex_t device_index, char const *request, char *response, uint32_t response_size) override;
+    vr::EVRFirmwareError PerformFirmwareUpdate(vr::TrackedDeviceIndex_t device_index) override;
+    void AcknowledgeQuit_Exiting() override;
+    void AcknowledgeQuit_UserPrompt() override;
+  };
+
+  class compositor_interface : public vr::IVRCompositor {
+    /// Synthetic implementation of the compositor interface, IVRCompositor_016
+    stub_runtime &parent;
+
+  public:
+    explicit compositor_interface(stub_runtime &this_parent);
+
+    void SetTrackingSpace(vr::ETrackingUniverseOrigin origin) override;
+    vr::ETrackingUniverseOrigin GetTrackingSpace() override;
+    vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *render_poses, uint32_t render_pose_count, vr::TrackedDevicePose_t *game_poses, uint32_t game_pose_count) override;
+    vr::EVRCompositorError GetLastPoses(vr::TrackedDevicePose_t *render_poses, uint32_t render_pose_count, vr::TrackedDevicePose_t *game_poses, uint32_t game_pose_count) override;
+    vr::EVRCompositorError GetLastPoseForTrackedDeviceIndex(vr::TrackedDeviceIndex_t device_index, vr::TrackedDevicePose_t *render_pose, vr::TrackedDevicePose_t *game_pose) override;
+    vr::EVRCompositorError Submit(vr::EVREye eye, vr::Texture_t const *texture, vr::VRTextureBounds_t const *bounds, vr::EVRSubmitFlags flags) override;
+    void ClearLastSubmittedFrame() override;
+    void PostPresentHandoff() override;
+    bool GetFrameTiming(vr::Compositor_FrameTiming *timing, uint32_t frames_ago) override;
+    float GetFrameTimeRemaining() override;
+    void GetCumulativeStats(vr::Compositor_CumulativeStats *stats, uint32_t stats_size) override;
+    void FadeToColor(float seconds, float red, float green, float blue, float alpha, bool background) override;
+    void FadeGrid(float seconds, bool fade_in) override;
+    vr::EVRCompositorError SetSkyboxOverride(vr::Texture_t const *textures, uint32_t texture_count) override;
+    void ClearSkyboxOverride() override;
+    void CompositorBringToFront() override;
+    void CompositorGoToBack() override;
+    void CompositorQuit() override;
+    bool IsFullscreen() override;
+    uint32_t GetCurrentSceneFocusProcess() override;
+    uint32_t GetLastFrameRenderer() override;
+    bool CanRenderScene() override;
+    void ShowMirrorWindow() override;
+    void HideMirrorWindow() override;
+    bool IsMirrorWindowVisible() override;
+    void CompositorDumpImages() override;
+    bool ShouldAppRenderWithLowResources() override;
+    void ForceInterleavedReprojectionOn(bool override_reprojection) override;
+    void ForceReconnectProcess() override;
+    void SuspendRendering(bool suspend) override;
+  };
+
+  static stub_runtime *active;                                                  // the runtime the loaded entry points refer to
+
+  system_interface system{*this};
+  compositor_interface compositor{*this};
+
+  std::chrono::steady_clock::time_point start_time;
+  std::atomic<uint64_t> frame{0};                                               // frames advanced by hand, when not paced
+  std::atomic<uint64_t> events_sent{0};
+  vr::ETrackingUniverseOrigin tracking_space = vr::TrackingUniverseStanding;
+
+  session_replay const *replay = nullptr;                                       // recording played back in place of synthetic data, if any
+  uint64_t replay_event_frame = 0;                                              // frame the replayed events are being read from, on the polling thread
+  unsigned int replay_event_index = 0;
+  uint64_t replay_pose_frame = std::numeric_limits<uint64_t>::max();           // frame whose first pose read, update()'s, has been served
+
+public:
+  void load(openvr_symbols &symbols, session_replay const *this_replay = nullptr);
+
+  void advance(uint64_t frames = 1);
+
+  uint64_t get_frame() const __attribute__((__pure__));
+  double get_time() const __attribute__((__pure__));
+
+private:
+  bool is_controller(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  bool is_connected(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  uint64_t get_events_due() const __attribute__((__pure__));
+  uint64_t get_buttons_pressed(vr::TrackedDeviceIndex_t device_index) const __attribute__((__pure__));
+  session_log_frame const &get_replay_frame() const __attribute__((__pure__));
+
+  void fill_pose(vr::TrackedDeviceIndex_t device_index, double time, vr::TrackedDevicePose_t &pose) const;
+  void fill_poses(double time, vr::TrackedDevicePose_t *poses, uint32_t pose_count) const;
+  bool fill_replay_render_poses(vr::TrackedDevicePose_t *poses, uint32_t pose_count);
+  void fill_controller_state(vr::TrackedDeviceIndex_t device_index, vr::VRControllerState_t &state) const;
+  bool fill_next_event(vr::VREvent_t &event);
+
+  // entry points that stand in for those loaded from the OpenVR library
+  static bool is_runtime_installed();
+  static char const *runtime_path();
+  static bool is_hmd_present();
+  static uint32_t init_internal(vr::EVRInitError *error, vr::EVRApplicationType application_type);
+  static void shutdown_internal();
+  static bool is_interface_version_valid(char const *version);
+  static char const *get_init_error_description(vr::EVRInitError error);
+  static void *get_generic_interface(char const *version, vr::EVRInitError *error);
+  static uint32_t get_init_token();
+};
+
+}
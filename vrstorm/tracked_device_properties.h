@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <string>
+#ifdef __MINGW32__
+  #include <openvr_mingw.hpp>
+#else
+  #include <openvr.h>
+#endif // __MINGW32__
+
+namespace vrstorm {
+
+struct tracked_device_properties {
+  /// Cached runtime properties of one tracked device, so the frame loop never has to query them
+  bool cached = false;                                                          // false until filled, and again after the device deactivates
+
+  vr::ETrackedDeviceClass device_class = vr::TrackedDeviceClass_Invalid;
+  vr::ETrackedControllerRole role = vr::TrackedControllerRole_Invalid;
+
+  std::string tracking_system_name;
+  std::string manufacturer_name;
+  std::string model_number;
+  std::string serial_number;
+  std::string render_model_name;
+
+  // controllers only
+  uint64_t supported_buttons = 0;
+  std::array<vr::EVRControllerAxisType, vr::k_unControllerStateAxisCount> axis_types{};
+  uint32_t axis_mask = 0;                                                       // bit per axis, set for each axis type other than none
+
+  // HMDs only
+  float user_ipd = 0.0f;
+  float display_frequency = 0.0f;
+  float vsync_to_photon_time = 0.0f;
+};
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace vrstorm {
+
+template<typename T>
+class triple_buffer {
+  /// Wait-free single producer, single consumer triple buffer
+  static uint_fast8_t constexpr index_mask = 0b011;                             // low bits of the shared slot are the buffer index
+  static uint_fast8_t constexpr fresh_bit  = 0b100;                             // set when the shared slot holds an unread buffer
+
+  std::array<T, 3> buffers;
+  uint_fast8_t back  = 0;                                                       // owned by the producer
+  std::atomic<uint_fast8_t> middle{1};                                          // shared between producer and consumer
+  uint_fast8_t front = 2;                                                       // owned by the consumer
+
+public:
+  T &get_back();
+  void publish();
+
+  T const &get_front();
+  bool has_fresh() const __attribute__((__pure__));
+};
+
+template<typename T>
+T &triple_buffer<T>::get_back() {
+  /// Producer: return the buffer to write the next value into
+  return buffers[back];
+}
+
+template<typename T>
+void triple_buffer<T>::publish() {
+  /// Producer: publish the back buffer to the consumer, taking the previous shared buffer to write into next
+  back = middle.exchange(back | fresh_bit, std::memory_order_acq_rel) & index_mask;
+}
+
+template<typename T>
+T const &triple_buffer<T>::get_front() {
+  /// Consumer: return the most recently published value, valid until the next call
+  if(middle.load(std::memory_order_relaxed) & fresh_bit) {                      // only swap if there's something new, otherwise keep reading the old front
+    front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+  }
+  return buffers[front];
+}
+
+template<typename T>
+bool triple_buffer<T>::has_fresh() const {
+  /// Consumer: whether a value has been published since the last get_front()
+  return middle.load(std::memory_order_relaxed) & fresh_bit;
+}
+
+}
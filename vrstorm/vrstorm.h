@@ -1,4 +1,20 @@
 #pragma once
 
 #include "manager.h"
+#include "adaptive_resolution.h"
 #include "controller.h"
+#include "device_registry.h"
+#include "eye_matrices.h"
+#include "frame_timing.h"
+#include "hidden_area_mask.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "openvr_symbols.h"
+#include "pose_snapshot.h"
+#include "pose_table.h"
+#include "render_model_cache.h"
+#include "render_model_loader.h"
+#include "rigid_pose.h"
+#include "session_log.h"
+#include "stub_runtime.h"
+#include "tracked_device_properties.h"
@@ -3,6 +3,29 @@
 namespace vrstorm {
 
 class manager;
+class adaptive_resolution;
 struct controller;
+class device_registry;
+struct eye_matrices;
+struct frame_timing_sample;
+struct frame_timing_stats;
+class frame_timing_ring;
+class hidden_area_mask;
+class logger;
+class mapped_file;
+struct openvr_symbols;
+struct pose_snapshot;
+class pose_table;
+class render_model_cache;
+class render_model_loader;
+struct rigid_pose;
+struct session_log_devices;
+struct session_log_header;
+struct session_log_frame;
+class session_recorder;
+class session_replay;
+class stub_runtime;
+struct tracked_device_properties;
+template<typename T> class triple_buffer;
 
 }